@@ -0,0 +1,236 @@
+/*
+ * outmap.cc - printing values of model based on outmap
+ * Author: Mateusz Szpakowski
+ * License: LGPL v2.0
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "satutils.h"
+
+namespace
+{
+
+enum OutmapToken
+{
+  OUTMAP_END = 0,
+  OUTMAP_CHAR,
+  OUTMAP_CONVERSION,
+  OUTMAP_ERROR
+};
+
+/* conversion: type (u,s,x,o or { for choices) and literals from lowest bit */
+struct OutmapConversion
+{
+  char type;
+  std::vector<std::string> choices;
+  SatUtils::LiteralVector literals;
+};
+
+/* read next character (unescaped) or conversion of outmap */
+OutmapToken
+read_outmap_token (std::istream& file, char& c, OutmapConversion& conversion)
+{
+  c = file.get ();
+  if (file.eof ())
+    return OUTMAP_END;
+  if (c == '\\')
+  {
+    c = file.get ();
+    if (file.eof ())
+      return OUTMAP_END;
+    return OUTMAP_CHAR;
+  }
+  else if (c != '{')
+    return OUTMAP_CHAR;
+
+  /* conversion */
+  conversion.choices.clear ();
+  conversion.literals.clear ();
+  file >> conversion.type;
+  if (conversion.type != 'u' && conversion.type != 's' &&
+      conversion.type != 'x' && conversion.type != 'o' &&
+      conversion.type != '{')
+  {
+    std::cerr << "Bad conversion type" << std::endl;
+    return OUTMAP_ERROR;
+  }
+
+  if (conversion.type == '{')
+  {
+    bool closed = false;
+    guint choice = 0;
+    conversion.choices.resize (1);
+    while (1)
+    {
+      c = file.get ();
+      if (file.eof ())
+        break;
+      if (c == '\\')
+      {
+        c = file.get ();
+        if (file.eof ())
+          break;
+        conversion.choices[choice].push_back (c);
+        continue;
+      }
+      else if (c == '}')
+      {
+        closed = true;
+        break;
+      }
+      else if (c == '|')
+      {
+        choice++;
+        conversion.choices.resize (conversion.choices.size () + 1);
+      }
+      else
+        conversion.choices[choice].push_back (c);
+    }
+    if (!closed)
+    {
+      std::cerr << "Braces is not closed" << std::endl;
+      return OUTMAP_ERROR;
+    }
+  }
+
+  file >> c;
+  if (c != ':')
+  {
+    std::cerr << "Colon is required after conversion type" << std::endl;
+    return OUTMAP_ERROR;
+  }
+
+  while (1)
+  {
+    file >> c;
+    if (file.eof ())
+    {
+      std::cerr << "Not closed brace at end file" << std::endl;
+      return OUTMAP_ERROR;
+    }
+    if (c == '}') /* if end of conversion */
+      break;
+    file.unget ();
+
+    if (conversion.literals.size () == 64)
+    {
+      std::cerr <<
+        "Only 64 literals is possible to use in conversion" << std::endl;
+      return OUTMAP_ERROR;
+    }
+    gint32 literal;
+    file >> literal;
+    if (file.fail ())
+    {
+      std::cerr << "Bad literal in conversion" << std::endl;
+      return OUTMAP_ERROR;
+    }
+    if (literal == 0)
+    {
+      std::cerr << "Bad literal must be nonzero" << std::endl;
+      return OUTMAP_ERROR;
+    }
+    conversion.literals.push_back (literal);
+  }
+  return OUTMAP_CONVERSION;
+}
+
+};
+
+bool
+SatUtils::print_output_based_on_outmap (std::istream& file,
+      const std::vector<bool>& instance, bool sat, std::ostream& os)
+{
+  if (!sat)
+  {
+    os << "Formulae is unsatisfiable!" << std::endl;
+    return true;
+  }
+  if (instance.size () == 0)
+  {
+    os << "Formulae is satisfiable." << std::endl;
+    return true;
+  }
+  
+  char c;
+  OutmapConversion conversion;
+  OutmapToken token;
+  while ((token = read_outmap_token (file, c, conversion)) != OUTMAP_END)
+  {
+    if (token == OUTMAP_ERROR)
+      return false;
+    if (token == OUTMAP_CHAR)
+    {
+      os << c;
+      continue;
+    }
+
+    guint64 value = 0;
+    const guint bits = conversion.literals.size ();
+    for (guint bit = 0; bit < bits; bit++)
+    {
+      gint32 literal = conversion.literals[bit];
+      gint32 valnum = std::abs (literal);
+      if (guint32 (valnum) <= instance.size ())
+        value |= (instance[valnum-1] == (literal > 0)) ? (1ULL << bit) : 0;
+    }
+    if (bits == 0)
+      continue;
+
+    if (conversion.type == 's')
+    { /* expand sign */
+      if (value & (1ULL << (bits-1)))
+        value |= (bits < 64) ? (G_MAXUINT64 ^ ((1ULL << bits)-1)) : 0;
+    }
+    
+    switch (conversion.type)
+    {
+      case 'u':
+        os << std::dec << guint64 (value);
+        break;
+      case 's':
+        os << std::dec << gint64 (value);
+        break;
+      case 'x':
+        os << std::hex << guint64 (value);
+        break;
+      case 'o':
+        os << std::oct << guint64 (value);
+        break;
+      case '{':
+        if (value < conversion.choices.size ())
+          os << conversion.choices[value];
+        else
+          os << "{!!!OUT OF RANGE!!!:" << value << '}';
+        break;
+      default:
+        break;
+    }
+  }
+  os.flush ();
+  return true;
+}
+
+bool
+SatUtils::get_outmap_variables (std::istream& file, LiteralVector& vars)
+{
+  vars.clear ();
+  char c;
+  OutmapConversion conversion;
+  OutmapToken token;
+  while ((token = read_outmap_token (file, c, conversion)) != OUTMAP_END)
+  {
+    if (token == OUTMAP_ERROR)
+      return false;
+    for (LiteralConstIter it = conversion.literals.begin ();
+         token == OUTMAP_CONVERSION && it != conversion.literals.end (); ++it)
+      vars.push_back (std::abs (*it));
+  }
+  std::sort (vars.begin (), vars.end ());
+  vars.erase (std::unique (vars.begin (), vars.end ()), vars.end ());
+  return true;
+}
@@ -6,6 +6,9 @@
 
 #include <fstream>
 #include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <map>
 #include "satutils.h"
 
 using namespace SatUtils;
@@ -61,19 +64,86 @@ CNFError::what () const
   return out;
 }
 
+/* PackedAssignments class */
+
+PackedAssignments::PackedAssignments ()
+    : vars_n (0), words_n (0)
+{
+}
+
+PackedAssignments::PackedAssignments (gint32 vars_n, guint32 models_n)
+{
+  resize (vars_n, models_n);
+}
+
+void
+PackedAssignments::resize (gint32 vars_n, guint32 models_n)
+{
+  this->vars_n = vars_n;
+  words_n = (models_n + 63) >> 6;
+  values.assign (gsize (vars_n) * words_n, 0);
+}
+
+void
+PackedAssignments::set (guint32 model, gint32 var, bool value)
+{
+  guint64& word = values[var * words_n + (model >> 6)];
+  guint64 bit = 1ULL << (model & 63);
+  word = (value) ? (word | bit) : (word & ~bit);
+}
+
+void
+PackedAssignments::fill (gint32 var, bool value)
+{
+  std::fill (values.begin () + var * words_n, values.begin () + (var+1) * words_n,
+        (value) ? G_MAXUINT64 : 0);
+}
+
+void
+PackedAssignments::set_model (guint32 model, const std::vector<bool>& v)
+{
+  for (gint32 i = 0; i < vars_n; i++)
+    set (model, i, v[i]);
+}
+
+void
+PackedAssignments::get_model (guint32 model, std::vector<bool>& v) const
+{
+  v.resize (vars_n);
+  for (gint32 i = 0; i < vars_n; i++)
+    v[i] = get (model, i);
+}
+
+void
+PackedAssignments::randomize (guint64 seed)
+{
+  guint64 x = (seed != 0) ? seed : 0x9e3779b97f4a7c15ULL;
+  for (std::vector<guint64>::iterator it = values.begin (); it != values.end (); ++it)
+  {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *it = x;
+  }
+}
+
 /* CNF class */
 
 CNF::CNF ()
-    : vars_n (0), clauses_n (0)
+    : vars_n (0), clauses_n (0), xors_n (0), cards_n (0), pbs_n (0),
+      softs_n (0)
 {
 }
 
 CNF::CNF (gint32 input_vars_n, guint32 input_clauses_n)
-    : vars_n (input_vars_n), clauses_n (input_clauses_n)
+    : vars_n (input_vars_n), clauses_n (input_clauses_n), xors_n (0),
+      cards_n (0), pbs_n (0), softs_n (0)
 {
 }
 
 CNF::CNF (const std::string& filename)
+    : vars_n (0), clauses_n (0), xors_n (0), cards_n (0), pbs_n (0),
+      softs_n (0)
 {
   load_from_file (filename);
 }
@@ -82,7 +152,44 @@ bool
 CNF::operator== (const CNF& cnf) const
 {
   return (vars_n == cnf.vars_n && clauses_n == cnf.clauses_n &&
-      formulae == cnf.formulae);
+      formulae == cnf.formulae && xors_n == cnf.xors_n && xors == cnf.xors &&
+      cards_n == cnf.cards_n && cards == cnf.cards &&
+      pbs_n == cnf.pbs_n && pbs == cnf.pbs && projection == cnf.projection &&
+      softs_n == cnf.softs_n && softs == cnf.softs &&
+      soft_weights == cnf.soft_weights);
+}
+
+/* projection comment: 'c p show var ... 0' or 'c ind var ... 0' */
+static void
+parse_projection_comment (const std::string& line, LiteralVector& projection)
+{
+  std::istringstream is (line);
+  std::string word;
+  is >> word >> word;
+  if (word == "p")
+  {
+    is >> word;
+    if (word != "show")
+      return;
+  }
+  else if (word != "ind")
+    return;
+
+  gint32 var;
+  while ((is >> var) && var != 0)
+    projection.push_back (var);
+}
+
+/* OPB statement has variable 'x<n>' or ends with ';' (WCNF line has not) */
+static bool
+is_opb_statement (const std::string& line)
+{
+  if (line.find (';') != std::string::npos)
+    return true;
+  for (std::string::size_type i = 0; i+1 < line.size (); i++)
+    if (line[i] == 'x' && line[i+1] >= '0' && line[i+1] <= '9')
+      return true;
+  return false;
 }
 
 void
@@ -92,13 +199,40 @@ CNF::load_from_file (const std::string& filename)
   if (!file)
     throw CNFError (CNFError::OPEN_ERROR, "Open error");
 
+  std::string line;
+  /* DIMACS starts with comment or problem line (or clause of WCNF),
+   * otherwise OPB */
+  file >> std::ws;
+  if (!file.eof () && file.peek () != 'c' && file.peek () != 'p' &&
+      file.peek () != 'h')
+  {
+    bool opb = true;
+    /* weight of soft clause of WCNF or coefficient of OPB term */
+    if (file.peek () >= '0' && file.peek () <= '9')
+    {
+      const std::streampos start = file.tellg ();
+      std::getline (file, line);
+      opb = is_opb_statement (line);
+      file.clear ();
+      file.seekg (start);
+    }
+    if (opb)
+    {
+      load_opb (file);
+      return;
+    }
+  }
 
   gint32 newvars_n;
   guint32 newclauses_n;
   LiteralVector newformulae;
+  guint32 newxors_n = 0;
+  LiteralVector newxors;
+  guint32 newcards_n = 0;
+  LiteralVector newcards;
+  LiteralVector newprojection;
 
   /* reading preamble */
-  std::string line;
   while (!file.eof ())
   {
     std::getline (file, line);
@@ -115,6 +249,22 @@ CNF::load_from_file (const std::string& filename)
 
     if (line.size () == 0 || line[0] != 'c')
       break;
+    parse_projection_comment (line, newprojection);
+  }
+
+  /* WCNF with problem line or without (clauses after comments) */
+  if (line.compare (0, 7, "p wcnf ") == 0)
+  {
+    load_wcnf (file, line);
+    return;
+  }
+  if (line.size () != 0 &&
+      (line[0] == 'h' || (line[0] >= '0' && line[0] <= '9')))
+  {
+    file.clear ();
+    file.seekg (0);
+    load_wcnf (file, "");
+    return;
   }
 
   {
@@ -126,7 +276,7 @@ CNF::load_from_file (const std::string& filename)
       throw CNFError (CNFError::BAD_FORMAT, "Bad format");
     char space = is.get ();
     is >> cnfstr;
-    if (cnfstr != "cnf" || space != ' ')
+    if ((cnfstr != "cnf" && cnfstr != "cnf+") || space != ' ')
       throw CNFError (CNFError::BAD_FORMAT, "Bad format");
     is >> newvars_n;
     is >> newclauses_n;
@@ -141,8 +291,50 @@ CNF::load_from_file (const std::string& filename)
   {
     LiteralVector clause;
     gint32 v;
+    bool is_xor = false;
+    bool is_card = false;
+
+    /* skip comments between clauses, 'x' starts XOR */
+    file >> std::ws;
+    while (file.peek () == 'c')
+    {
+      std::getline (file, line);
+      parse_projection_comment (line, newprojection);
+      file >> std::ws;
+    }
+    if (file.peek () == 'x')
+    {
+      file.get ();
+      is_xor = true;
+    }
+
     while (1)
     {
+      /* cardinality constraint: literals, '<=' or '>=' and bound */
+      file >> std::ws;
+      if (!is_xor && (file.peek () == '<' || file.peek () == '>'))
+      {
+        std::string op;
+        gint64 bound;
+        file >> op >> bound;
+        if (file.fail () || (op != "<=" && op != ">=") || bound < 0)
+          throw CNFError (CNFError::BAD_FORMAT, "Bad format");
+        if (op == ">=")
+        {
+          /* at least more literals than constraint has: bad constraint */
+          if (bound > gint64 (clause.size ()))
+            throw CNFError (CNFError::BAD_FORMAT,
+                  "Bound of cardinality constraint is too big");
+          /* at least bound <=> at most size-bound of negations */
+          for (LiteralIter it = clause.begin (); it != clause.end (); ++it)
+            *it = -*it;
+          bound = clause.size () - bound;
+        }
+        v = bound;
+        is_card = true;
+        break;
+      }
+
       file >> v;
 
       if (file.eof () && (v != 0 || i+1 < newclauses_n))
@@ -165,14 +357,56 @@ CNF::load_from_file (const std::string& filename)
         break;
     }
 
-    newformulae.push_back (clause.size ());
-    newformulae.insert (newformulae.end (), clause.begin (), clause.end ());
+    if (is_card)
+    {
+      newcards.push_back (clause.size ());
+      newcards.push_back (v);
+      newcards.insert (newcards.end (), clause.begin (), clause.end ());
+      newcards_n++;
+    }
+    else if (is_xor)
+    {
+      newxors.push_back (clause.size ());
+      newxors.insert (newxors.end (), clause.begin (), clause.end ());
+      newxors_n++;
+    }
+    else
+    {
+      newformulae.push_back (clause.size ());
+      newformulae.insert (newformulae.end (), clause.begin (), clause.end ());
+    }
+  }
+  /* comments after last clause */
+  file >> std::ws;
+  while (file.peek () == 'c')
+  {
+    std::getline (file, line);
+    parse_projection_comment (line, newprojection);
+    file >> std::ws;
   }
 
+  for (LiteralConstIter it = newprojection.begin ();
+       it != newprojection.end (); ++it)
+    if (*it <= 0 || *it > newvars_n)
+      throw CNFError (CNFError::BAD_LITERAL, "Bad projection variable");
+  std::sort (newprojection.begin (), newprojection.end ());
+  newprojection.erase (std::unique (newprojection.begin (),
+        newprojection.end ()), newprojection.end ());
+
   /* replace old CNF by new loaded from file */
   vars_n = newvars_n;
-  clauses_n = newclauses_n;
+  clauses_n = newclauses_n - newxors_n - newcards_n;
   formulae = newformulae;
+  xors_n = newxors_n;
+  xors = newxors;
+  cards_n = newcards_n;
+  cards = newcards;
+  pbs_n = 0;
+  pbs.clear ();
+  projection = newprojection;
+  softs_n = 0;
+  softs.clear ();
+  soft_weights.clear ();
 }
 
 void
@@ -182,8 +416,28 @@ CNF::save_to_file (const std::string& filename) const
   if (!file)
     throw CNFError (CNFError::OPEN_ERROR, "Open error");
 
+  if (softs_n != 0)
+  {
+    save_wcnf (file);
+    return;
+  }
+  if (pbs_n != 0)
+  {
+    save_opb (file);
+    return;
+  }
+
   file << "c saved by SATIO"
-      "\np cnf " << vars_n << ' ' << clauses_n << '\n';
+      "\np " << ((cards_n != 0) ? "cnf+ " : "cnf ") << vars_n << ' ' <<
+      (clauses_n + xors_n + cards_n) << '\n';
+  if (!projection.empty ())
+  {
+    file << "c p show";
+    for (LiteralConstIter it = projection.begin ();
+         it != projection.end (); ++it)
+      file << ' ' << *it;
+    file << " 0\n";
+  }
 
   LiteralConstIter literal = formulae.begin ();
   for (guint32 i = 0; i < clauses_n; i++)
@@ -196,6 +450,340 @@ CNF::save_to_file (const std::string& filename) const
     if (file.fail ())
       throw CNFError (CNFError::IO_ERROR, "I/O error");
   }
+
+  literal = xors.begin ();
+  for (guint32 i = 0; i < xors_n; i++)
+  {
+    gint32 literals_n = *literal++;
+    file << 'x';
+    for (gint32 j = 0; j < literals_n; j++)
+      file << literal[j] << ' ';
+    file << "0\n";
+    literal += literals_n;
+    if (file.fail ())
+      throw CNFError (CNFError::IO_ERROR, "I/O error");
+  }
+
+  literal = cards.begin ();
+  for (guint32 i = 0; i < cards_n; i++)
+  {
+    gint32 literals_n = *literal++;
+    gint32 bound = *literal++;
+    for (gint32 j = 0; j < literals_n; j++)
+      file << literal[j] << ' ';
+    file << "<= " << bound << '\n';
+    literal += literals_n;
+    if (file.fail ())
+      throw CNFError (CNFError::IO_ERROR, "I/O error");
+  }
+}
+
+/* OPB format: lines '[coefficient literal] ... relation bound ;' */
+
+namespace
+{
+
+/* parse literal 'x1' or '~x1' */
+static gint32
+parse_opb_literal (const std::string& token)
+{
+  std::string::size_type pos = (token.size () != 0 && token[0] == '~') ? 1 : 0;
+  if (pos >= token.size () || token[pos] != 'x')
+    throw CNFError (CNFError::BAD_LITERAL, "Bad literal");
+  std::istringstream is (token.substr (pos + 1));
+  gint32 var;
+  is >> var;
+  if (is.fail () || !is.eof () || var <= 0)
+    throw CNFError (CNFError::BAD_LITERAL, "Bad literal");
+  return (pos != 0) ? -var : var;
+}
+
+static void
+write_opb_term (std::ostream& os, gint64 coef, gint32 literal)
+{
+  os << ((coef >= 0) ? "+" : "") << coef << ((literal < 0) ? " ~x" : " x") <<
+      ((literal < 0) ? -literal : literal) << ' ';
+}
+
+};
+
+void
+CNF::load_opb (std::istream& is)
+{
+  CNF newcnf;
+  gint32 header_vars_n = 0;
+  gint32 max_var = 0;
+  std::string line;
+  std::string statement;
+  PBVector coefs;
+  LiteralVector literals;
+
+  while (std::getline (is, line))
+  {
+    std::string::size_type start = line.find_first_not_of (" \t\r");
+    if (start == std::string::npos)
+      continue;
+    if (line[start] == '*')
+    { /* comment, can contain number of variables */
+      std::string::size_type vpos = line.find ("#variable=");
+      if (vpos != std::string::npos)
+      {
+        std::istringstream vis (line.substr (vpos + 10));
+        vis >> header_vars_n;
+      }
+      continue;
+    }
+
+    statement += ' ';
+    statement += line;
+    std::string::size_type end;
+    while ((end = statement.find (';')) != std::string::npos)
+    {
+      std::istringstream sis (statement.substr (0, end));
+      statement.erase (0, end + 1);
+      std::string token;
+      if (!(sis >> token))
+        continue;
+      if (token == "min:" || token == "max:")
+        continue; /* objective is not used */
+
+      coefs.clear ();
+      literals.clear ();
+      std::string relation;
+      do
+      {
+        if (token == ">=" || token == "<=" || token == "=")
+        {
+          relation = token;
+          break;
+        }
+        std::istringstream cis (token);
+        gint64 coef;
+        cis >> coef;
+        if (cis.fail () || !cis.eof () || !(sis >> token))
+          throw CNFError (CNFError::BAD_FORMAT, "Bad format");
+        gint32 literal = parse_opb_literal (token);
+        max_var = std::max (max_var, (literal > 0) ? literal : -literal);
+        coefs.push_back (coef);
+        literals.push_back (literal);
+      } while (sis >> token);
+
+      gint64 bound;
+      if (relation.empty () || !(sis >> bound))
+        throw CNFError (CNFError::BAD_FORMAT, "Bad format");
+      if (sis >> token)
+        throw CNFError (CNFError::BAD_FORMAT,
+              "Non-linear constraints are not supported");
+      if (relation == ">=")
+        newcnf.add_pb_at_least (coefs, literals, bound);
+      else if (relation == "<=")
+        newcnf.add_pb_at_most (coefs, literals, bound);
+      else
+        newcnf.add_pb_equal (coefs, literals, bound);
+    }
+  }
+  if (is.bad ())
+    throw CNFError (CNFError::IO_ERROR, "I/O error");
+  if (statement.find_first_not_of (" \t\r") != std::string::npos)
+    throw CNFError (CNFError::END_OF_FILE, "End of file");
+
+  newcnf.vars_n = std::max (header_vars_n, max_var);
+  if (newcnf.vars_n <= 0)
+    throw CNFError (CNFError::BAD_FORMAT,
+          "Number of variables must be grater than 0.");
+  *this = newcnf;
+}
+
+void
+CNF::save_opb (std::ostream& os) const
+{
+  if (xors_n != 0)
+    throw CNFError (CNFError::BAD_FORMAT, "XORs can't be saved in OPB format");
+
+  os << "* #variable= " << vars_n << " #constraint= " <<
+      (clauses_n + cards_n + pbs_n) << "\n* saved by SATIO\n";
+
+  LiteralConstIter literal = formulae.begin ();
+  for (guint32 i = 0; i < clauses_n; i++)
+  {
+    gint32 literals_n = *literal++;
+    for (gint32 j = 0; j < literals_n; j++)
+      write_opb_term (os, 1, literal[j]);
+    os << ">= 1 ;\n";
+    literal += literals_n;
+  }
+
+  literal = cards.begin ();
+  for (guint32 i = 0; i < cards_n; i++)
+  {
+    gint32 literals_n = *literal++;
+    gint32 bound = *literal++;
+    for (gint32 j = 0; j < literals_n; j++)
+      write_opb_term (os, -1, literal[j]);
+    os << ">= " << -bound << " ;\n";
+    literal += literals_n;
+  }
+
+  PBVector::const_iterator pb = pbs.begin ();
+  for (guint32 i = 0; i < pbs_n; i++)
+  {
+    gint64 terms_n = *pb++;
+    gint64 bound = *pb++;
+    for (gint64 j = 0; j < terms_n; j++)
+      write_opb_term (os, pb[2*j], pb[2*j+1]);
+    os << ">= " << bound << " ;\n";
+    pb += 2*terms_n;
+  }
+  if (os.fail ())
+    throw CNFError (CNFError::IO_ERROR, "I/O error");
+}
+
+/* WCNF format: problem line 'p wcnf vars clauses [top]' and lines
+ * 'weight literal ... 0' (clauses with weight top are hard), or lines
+ * 'h literal ... 0' (hard) and 'weight literal ... 0' without problem line */
+
+void
+CNF::load_wcnf (std::istream& is, const std::string& problem_line)
+{
+  CNF newcnf;
+  gint32 header_vars_n = 0;
+  guint32 header_clauses_n = 0;
+  guint64 top = G_MAXUINT64;
+  if (problem_line.size () != 0)
+  {
+    std::istringstream ls (problem_line);
+    std::string p, format;
+    ls >> p >> format >> header_vars_n >> header_clauses_n;
+    if (ls.fail ())
+      throw CNFError (CNFError::BAD_FORMAT, "Can't parse formulae size");
+    if (header_vars_n <= 0)
+      throw CNFError (CNFError::BAD_FORMAT,
+            "Number of variables must be grater than 0.");
+    if (!(ls >> top))
+      top = G_MAXUINT64;
+  }
+
+  gint32 max_var = 0;
+  guint32 read_n = 0;
+  std::vector<LiteralVector> hards;
+  LiteralVector clause;
+  std::string line;
+  std::string token;
+  while (true)
+  {
+    is >> std::ws;
+    if (is.eof ())
+      break;
+    if (is.peek () == 'c')
+    {
+      std::getline (is, line);
+      parse_projection_comment (line, newcnf.projection);
+      continue;
+    }
+
+    is >> token;
+    bool hard = (token == "h" && problem_line.size () == 0);
+    guint64 weight = 0;
+    if (!hard)
+    {
+      std::istringstream ws (token);
+      ws >> weight;
+      if (ws.fail () || !ws.eof ())
+        throw CNFError (CNFError::BAD_FORMAT, "Bad weight");
+      hard = (weight >= top);
+    }
+
+    clause.clear ();
+    gint32 literal;
+    while ((is >> literal) && literal != 0)
+    {
+      if (header_vars_n != 0 &&
+          (literal < -header_vars_n || literal > header_vars_n))
+        throw CNFError (CNFError::BAD_LITERAL, "Bad format");
+      max_var = std::max (max_var, std::abs (literal));
+      clause.push_back (literal);
+    }
+    if (is.fail ())
+    {
+      if (is.eof ())
+        throw CNFError (CNFError::END_OF_FILE, "End of file");
+      throw CNFError (CNFError::BAD_FORMAT, "Bad format");
+    }
+
+    if (hard)
+      hards.push_back (clause);
+    else
+      newcnf.add_soft_clause (clause, weight);
+    read_n++;
+  }
+  if (read_n < header_clauses_n)
+    throw CNFError (CNFError::END_OF_FILE, "End of file");
+
+  newcnf.vars_n = std::max (header_vars_n, max_var);
+  if (newcnf.vars_n <= 0)
+    throw CNFError (CNFError::BAD_FORMAT,
+          "Number of variables must be grater than 0.");
+  for (std::vector<LiteralVector>::const_iterator it = hards.begin ();
+       it != hards.end (); ++it)
+    newcnf.add_clause (*it);
+
+  for (LiteralConstIter it = newcnf.projection.begin ();
+       it != newcnf.projection.end (); ++it)
+    if (*it <= 0 || *it > newcnf.vars_n)
+      throw CNFError (CNFError::BAD_LITERAL, "Bad projection variable");
+  std::sort (newcnf.projection.begin (), newcnf.projection.end ());
+  newcnf.projection.erase (std::unique (newcnf.projection.begin (),
+        newcnf.projection.end ()), newcnf.projection.end ());
+  *this = newcnf;
+}
+
+void
+CNF::save_wcnf (std::ostream& os) const
+{
+  if (xors_n != 0 || cards_n != 0 || pbs_n != 0)
+    throw CNFError (CNFError::BAD_FORMAT,
+          "Only clauses can be saved in WCNF format");
+
+  /* top is greater than cost of any model */
+  guint64 top = 1;
+  for (std::vector<guint64>::const_iterator it = soft_weights.begin ();
+       it != soft_weights.end (); ++it)
+    top += *it;
+
+  os << "c saved by SATIO\np wcnf " << vars_n << ' ' <<
+      (clauses_n + softs_n) << ' ' << top << '\n';
+  if (!projection.empty ())
+  {
+    os << "c p show";
+    for (LiteralConstIter it = projection.begin ();
+         it != projection.end (); ++it)
+      os << ' ' << *it;
+    os << " 0\n";
+  }
+
+  LiteralConstIter literal = formulae.begin ();
+  for (guint32 i = 0; i < clauses_n; i++)
+  {
+    gint32 literals_n = *literal++;
+    os << top;
+    for (gint32 j = 0; j < literals_n; j++)
+      os << ' ' << literal[j];
+    os << " 0\n";
+    literal += literals_n;
+  }
+
+  literal = softs.begin ();
+  for (guint32 i = 0; i < softs_n; i++)
+  {
+    gint32 literals_n = *literal++;
+    os << soft_weights[i];
+    for (gint32 j = 0; j < literals_n; j++)
+      os << ' ' << literal[j];
+    os << " 0\n";
+    literal += literals_n;
+  }
+  if (os.fail ())
+    throw CNFError (CNFError::IO_ERROR, "I/O error");
 }
 
 gint32
@@ -243,16 +831,99 @@ CNF::check_consistency () const
 
     index += clause_size + 1;
   }
+
+  index = 0;
+  gsize xors_size = xors.size ();
+  for (guint32 i = 0; i < xors_n; i++)
+  {
+    if (index >= xors_size)
+      return false;
+    guint32 xor_size = xors[index];
+    if (index + xor_size >= xors_size)
+      return false;
+
+    for (guint j = 0; j < xor_size; j++)
+      if (xors[index+j+1] < -vars_n || xors[index+j+1] > vars_n)
+        return false;
+
+    index += xor_size + 1;
+  }
+
+  index = 0;
+  gsize cards_size = cards.size ();
+  for (guint32 i = 0; i < cards_n; i++)
+  {
+    if (index + 1 >= cards_size)
+      return false;
+    guint32 card_size = cards[index];
+    if (index + card_size + 1 >= cards_size || cards[index+1] < 0)
+      return false;
+
+    for (guint j = 0; j < card_size; j++)
+      if (cards[index+j+2] < -vars_n || cards[index+j+2] > vars_n ||
+          cards[index+j+2] == 0)
+        return false;
+
+    index += card_size + 2;
+  }
+
+  index = 0;
+  gsize pbs_size = pbs.size ();
+  for (guint32 i = 0; i < pbs_n; i++)
+  {
+    if (index + 1 >= pbs_size)
+      return false;
+    gint64 terms_n = pbs[index];
+    if (terms_n < 0 || index + 2*terms_n + 2 > pbs_size)
+      return false;
+
+    for (gint64 j = 0; j < terms_n; j++)
+    {
+      gint64 literal = pbs[index + 2*j + 3];
+      if (pbs[index + 2*j + 2] <= 0 || literal < -vars_n ||
+          literal > vars_n || literal == 0)
+        return false;
+    }
+
+    index += 2*terms_n + 2;
+  }
   return true;
 }
 
 /* managing formulae */
 
+void
+CNF::normalize_clauses ()
+{
+  guint32 idx = 0;
+  guint32 newidx = 0;
+  for (guint i = 0; i < clauses_n; i++)
+  {
+    guint32 clause_size = formulae[idx];
+    std::sort (formulae.begin () + idx + 1,
+        formulae.begin () + idx + clause_size + 1);
+    LiteralIter it = std::unique_copy (formulae.begin () + idx + 1,
+        formulae.begin () + idx + clause_size + 1,
+        formulae.begin () + newidx + 1);
+    formulae[newidx] = it - (formulae.begin () + newidx + 1);
+
+    idx += clause_size + 1;
+    newidx += formulae[newidx] + 1;
+  }
+  formulae.resize (newidx);
+}
+
 void
 CNF::clear ()
 {
-  vars_n = clauses_n = 0;
+  vars_n = clauses_n = xors_n = cards_n = pbs_n = softs_n = 0;
   formulae.clear ();
+  xors.clear ();
+  cards.clear ();
+  pbs.clear ();
+  projection.clear ();
+  softs.clear ();
+  soft_weights.clear ();
 }
 
 void
@@ -384,6 +1055,430 @@ CNF::add_clause (gint32 l1, gint32 l2, gint32 l3, gint32 l4)
     add_empty_clause ();
 }
 
+void
+CNF::add_soft_clause (const LiteralVector& literals, guint64 weight)
+{
+  guint32 count = 0;
+  for (LiteralConstIter it = literals.begin (); it != literals.end (); ++it)
+    if (*it != 0)
+      count++;
+
+  softs.push_back (count);
+  for (LiteralConstIter it = literals.begin (); it != literals.end (); ++it)
+    if (*it != 0)
+      softs.push_back (*it);
+  soft_weights.push_back (weight);
+  softs_n++;
+}
+
+void
+CNF::add_xor (const LiteralVector& literals)
+{
+  gint32 count = 0;
+  for (LiteralConstIter it = literals.begin (); it != literals.end (); ++it)
+    if (*it != 0)
+      count++;
+
+  xors.push_back (count);
+  for (LiteralConstIter it = literals.begin (); it != literals.end (); ++it)
+    if (*it != 0)
+      xors.push_back (*it);
+  xors_n++;
+}
+
+void
+CNF::xors_to_clauses ()
+{
+  /* XORs longer than this are cut */
+  static const guint32 max_xor_size = 4;
+
+  LiteralConstIter literal = xors.begin ();
+  for (guint32 i = 0; i < xors_n; i++)
+  {
+    gint32 literals_n = *literal++;
+    /* remove pairs of same variables, negation changes parity */
+    LiteralVector vars;
+    bool parity = true;
+    for (gint32 j = 0; j < literals_n; j++)
+    {
+      gint32 var = std::abs (literal[j]);
+      if (literal[j] < 0)
+        parity = !parity;
+      LiteralIter it = std::find (vars.begin (), vars.end (), var);
+      if (it != vars.end ())
+        vars.erase (it);
+      else
+        vars.push_back (var);
+    }
+    literal += literals_n;
+
+    if (vars.empty ())
+    {
+      if (parity)
+        add_empty_clause ();
+      continue;
+    }
+    if (!parity)
+      vars[0] = -vars[0];
+
+    /* cut: l1^l2^l3^rest = 1 -> l1^l2^l3^-t = 1, t^rest = 1 */
+    while (vars.size () > max_xor_size)
+    {
+      gint32 t = add_var ();
+      LiteralVector rest;
+      rest.push_back (t);
+      rest.insert (rest.end (), vars.begin () + max_xor_size - 1, vars.end ());
+      vars.resize (max_xor_size - 1);
+      vars.push_back (-t);
+      add_xor_clauses (vars);
+      vars.swap (rest);
+    }
+    add_xor_clauses (vars);
+  }
+  xors_n = 0;
+  xors.clear ();
+}
+
+void
+CNF::add_xor_clauses (const LiteralVector& literals)
+{
+  /* clauses forbid assignments with even number of true literals:
+   * clause negates literals with even count of negations */
+  guint32 literals_n = literals.size ();
+  LiteralVector clause (literals_n);
+  for (guint32 mask = 0; mask < (1U << literals_n); mask++)
+  {
+    if ((__builtin_popcount (mask) & 1) != 0)
+      continue;
+    for (guint32 j = 0; j < literals_n; j++)
+      clause[j] = ((mask >> j) & 1) ? -literals[j] : literals[j];
+    add_clause (clause);
+  }
+}
+
+void
+CNF::add_at_most (const LiteralVector& literals, guint32 bound)
+{
+  gint32 count = 0;
+  for (LiteralConstIter it = literals.begin (); it != literals.end (); ++it)
+    if (*it != 0)
+      count++;
+
+  cards.push_back (count);
+  cards.push_back (bound);
+  for (LiteralConstIter it = literals.begin (); it != literals.end (); ++it)
+    if (*it != 0)
+      cards.push_back (*it);
+  cards_n++;
+}
+
+void
+CNF::add_at_least (const LiteralVector& literals, guint32 bound)
+{
+  LiteralVector negated;
+  for (LiteralConstIter it = literals.begin (); it != literals.end (); ++it)
+    if (*it != 0)
+      negated.push_back (-*it);
+  if (bound > negated.size ())
+    add_empty_clause ();
+  else
+    add_at_most (negated, negated.size () - bound);
+}
+
+void
+CNF::cards_to_clauses ()
+{
+  LiteralConstIter literal = cards.begin ();
+  for (guint32 i = 0; i < cards_n; i++)
+  {
+    guint32 n = *literal++;
+    guint32 k = *literal++;
+    const LiteralConstIter x = literal;
+    literal += n;
+    if (k >= n)
+      continue;
+    if (k == 0)
+    {
+      for (guint32 j = 0; j < n; j++)
+        add_clause (-x[j]);
+      continue;
+    }
+
+    /* sequential counter: s[j*k+c] - at least c+1 of x[0..j] are true */
+    LiteralVector s = add_vars_with_literals ((n-1)*k);
+    add_clause (-x[0], s[0]);
+    for (guint32 c = 1; c < k; c++)
+      add_clause (-s[c]);
+    for (guint32 j = 1; j < n-1; j++)
+    {
+      add_clause (-x[j], s[j*k]);
+      add_clause (-s[(j-1)*k], s[j*k]);
+      for (guint32 c = 1; c < k; c++)
+      {
+        add_clause (-x[j], -s[(j-1)*k + c-1], s[j*k + c]);
+        add_clause (-s[(j-1)*k + c], s[j*k + c]);
+      }
+      add_clause (-x[j], -s[(j-1)*k + k-1]);
+    }
+    add_clause (-x[n-1], -s[(n-2)*k + k-1]);
+  }
+  cards_n = 0;
+  cards.clear ();
+}
+
+void
+CNF::add_pb_at_least (const PBVector& coefs, const LiteralVector& literals,
+      gint64 bound)
+{
+  /* negative coefficient: c*l = -c*(-l) + c */
+  gsize start = pbs.size ();
+  pbs.push_back (0);
+  pbs.push_back (bound);
+  for (guint32 i = 0; i < literals.size (); i++)
+  {
+    if (coefs[i] == 0 || literals[i] == 0)
+      continue;
+    if (coefs[i] > 0)
+    {
+      pbs.push_back (coefs[i]);
+      pbs.push_back (literals[i]);
+    }
+    else
+    {
+      pbs.push_back (-coefs[i]);
+      pbs.push_back (-literals[i]);
+      pbs[start + 1] -= coefs[i];
+    }
+    pbs[start]++;
+  }
+  pbs_n++;
+}
+
+void
+CNF::add_pb_at_most (const PBVector& coefs, const LiteralVector& literals,
+      gint64 bound)
+{
+  PBVector negcoefs (coefs.size ());
+  for (guint32 i = 0; i < coefs.size (); i++)
+    negcoefs[i] = -coefs[i];
+  add_pb_at_least (negcoefs, literals, -bound);
+}
+
+void
+CNF::add_pb_equal (const PBVector& coefs, const LiteralVector& literals,
+      gint64 bound)
+{
+  add_pb_at_least (coefs, literals, bound);
+  add_pb_at_most (coefs, literals, bound);
+}
+
+namespace
+{
+
+/*
+ * node of decision diagram: sum of coefficients of true literals
+ * from index is at least bound. node variable implies this condition.
+ */
+/* decision diagram of sum of terms at least bound. nodes are built first,
+ * so diagram can be rejected if it is too big */
+class PBEncoder
+{
+private:
+  struct Node
+  {
+    guint32 index;
+    guint32 without;
+    guint32 with;
+  };
+  const gint64* terms; /* coefficient, literal */
+  std::vector<gint64> rest_sums;
+  std::map<std::pair<guint32, gint64>, guint32> node_map;
+  std::vector<Node> nodes;
+  guint32 max_nodes_n;
+public:
+  enum { NODE_FALSE = 0, NODE_TRUE = 1, NODE_TOO_BIG = G_MAXUINT32 };
+
+  PBEncoder (const gint64* interms, guint32 terms_n, guint32 in_max_nodes_n)
+      : terms (interms), rest_sums (terms_n + 1, 0), nodes (2),
+        max_nodes_n (in_max_nodes_n)
+  {
+    for (guint32 i = terms_n; i > 0; i--)
+      rest_sums[i-1] = rest_sums[i] + terms[2*(i-1)];
+  }
+
+  guint32 node (guint32 index, gint64 bound)
+  {
+    if (bound <= 0)
+      return NODE_TRUE;
+    if (rest_sums[index] < bound)
+      return NODE_FALSE;
+    std::pair<guint32, gint64> key (index, bound);
+    std::map<std::pair<guint32, gint64>, guint32>::const_iterator it =
+        node_map.find (key);
+    if (it != node_map.end ())
+      return it->second;
+    if (nodes.size () >= max_nodes_n)
+      return NODE_TOO_BIG;
+
+    guint32 without = node (index + 1, bound);
+    if (without == NODE_TOO_BIG)
+      return NODE_TOO_BIG;
+    guint32 with = node (index + 1, bound - terms[2*index]);
+    if (with == NODE_TOO_BIG)
+      return NODE_TOO_BIG;
+    Node newnode = { index, without, with };
+    node_map[key] = nodes.size ();
+    nodes.push_back (newnode);
+    return nodes.size () - 1;
+  }
+
+  /* add clauses of nodes and unit clause of root */
+  void generate (CNF& cnf, guint32 root) const
+  {
+    if (root == NODE_FALSE)
+    {
+      cnf.add_empty_clause ();
+      return;
+    }
+    if (root == NODE_TRUE)
+      return;
+    /* variable of node i is first + i */
+    gint32 first = cnf.next_var () - 2;
+    cnf.add_vars (nodes.size () - 2);
+    for (guint32 i = 2; i < nodes.size (); i++)
+    {
+      const Node& n = nodes[i];
+      gint32 var = first + i;
+      gint32 literal = terms[2*n.index + 1];
+      /* var -> (literal or without) and var -> with */
+      if (n.without == NODE_FALSE)
+        cnf.add_clause (-var, literal);
+      else if (n.without != NODE_TRUE)
+        cnf.add_clause (-var, literal, first + n.without);
+      if (n.with != NODE_TRUE)
+        cnf.add_clause (-var, first + n.with);
+    }
+    cnf.add_clause (first + root);
+  }
+};
+
+/* output is sum bit (parity) or carry (majority) of 2 or 3 inputs */
+static void
+add_adder_output (CNF& cnf, const gint32* inputs, guint32 inputs_n,
+      gint32 output, bool carry)
+{
+  LiteralVector clause (inputs_n + 1);
+  for (guint32 m = 0; m < (1U<<inputs_n); m++)
+  {
+    guint32 ones_n = 0;
+    for (guint32 j = 0; j < inputs_n; j++)
+    {
+      bool value = (m & (1U<<j)) != 0;
+      clause[j] = (value) ? -inputs[j] : inputs[j];
+      ones_n += (value) ? 1 : 0;
+    }
+    bool out = (carry) ? (ones_n >= 2) : ((ones_n & 1) != 0);
+    clause[inputs_n] = (out) ? output : -output;
+    cnf.add_clause (clause);
+  }
+}
+
+/*
+ * sum of terms computed by adders over columns of bits of coefficients
+ * and compared with bound, size grows with number of bits of coefficients.
+ */
+static void
+generate_pb_adders (CNF& cnf, const gint64* terms, guint32 terms_n,
+      gint64 bound)
+{
+  std::vector<LiteralVector> columns;
+  for (guint32 i = 0; i < terms_n; i++)
+    for (guint32 j = 0; (terms[2*i] >> j) != 0; j++)
+      if ((terms[2*i] >> j) & 1)
+      {
+        if (columns.size () <= j)
+          columns.resize (j + 1);
+        columns[j].push_back (terms[2*i + 1]);
+      }
+
+  LiteralVector outs;
+  for (guint32 j = 0; j < columns.size (); j++)
+  {
+    while (columns[j].size () >= 2)
+    {
+      guint32 inputs_n = std::min (gsize (3), columns[j].size ());
+      gint32 inputs[3];
+      std::copy (columns[j].end () - inputs_n, columns[j].end (), inputs);
+      columns[j].resize (columns[j].size () - inputs_n);
+      gint32 sum = cnf.add_var ();
+      gint32 carry = cnf.add_var ();
+      add_adder_output (cnf, inputs, inputs_n, sum, false);
+      add_adder_output (cnf, inputs, inputs_n, carry, true);
+      columns[j].push_back (sum);
+      if (columns.size () <= j + 1)
+        columns.resize (j + 2);
+      columns[j + 1].push_back (carry);
+    }
+    if (columns[j].empty ())
+    {
+      /* constant false bit */
+      gint32 var = cnf.add_var ();
+      cnf.add_clause (-var);
+      outs.push_back (var);
+    }
+    else
+      outs.push_back (columns[j][0]);
+  }
+
+  /* ge - bits of sum from 0 to j are at least bits of bound, 0 if true */
+  gint32 ge = 0;
+  for (guint32 j = 0; j < outs.size (); j++)
+  {
+    bool bit = ((bound >> j) & 1) != 0;
+    if (!bit && ge == 0)
+      continue;
+    gint32 var = cnf.add_var ();
+    if (bit)
+    { /* var -> out and ge */
+      cnf.add_clause (-var, outs[j]);
+      if (ge != 0)
+        cnf.add_clause (-var, ge);
+    }
+    else /* var -> out or ge */
+      cnf.add_clause (-var, outs[j], ge);
+    ge = var;
+  }
+  cnf.add_clause (ge);
+}
+
+};
+
+void
+CNF::pbs_to_clauses ()
+{
+  PBVector oldpbs;
+  oldpbs.swap (pbs);
+  guint32 oldpbs_n = pbs_n;
+  pbs_n = 0;
+  const gint64* pb = (oldpbs_n != 0) ? &oldpbs[0] : NULL;
+  for (guint32 i = 0; i < oldpbs_n; i++)
+  {
+    guint32 terms_n = *pb++;
+    gint64 bound = *pb++;
+    /* decision diagram is used if it is not much bigger than adders */
+    guint32 bits_n = 0;
+    for (guint32 j = 0; j < terms_n; j++)
+      bits_n += __builtin_popcountll (pb[2*j]);
+    PBEncoder encoder (pb, terms_n, 16*bits_n + 1024);
+    guint32 root = encoder.node (0, bound);
+    if (root != PBEncoder::NODE_TOO_BIG)
+      encoder.generate (*this, root);
+    else
+      generate_pb_adders (*this, pb, terms_n, bound);
+    pb += 2*terms_n;
+  }
+}
+
 bool
 CNF::evaluate (const std::vector<bool>& v) const
 {
@@ -403,9 +1498,184 @@ CNF::evaluate (const std::vector<bool>& v) const
       return false;
     index += clause_size + 1;
   }
+
+  index = 0;
+  for (guint32 i = 0; i < xors_n; i++)
+  {
+    guint32 xor_size = xors[index];
+    bool xor_result = false;
+    for (guint j = 1; j <= xor_size; j++)
+      if ((xors[index+j] > 0) == v[std::abs (xors[index+j])-1])
+        xor_result = !xor_result;
+    if (!xor_result)
+      return false;
+    index += xor_size + 1;
+  }
+
+  index = 0;
+  for (guint32 i = 0; i < cards_n; i++)
+  {
+    guint32 card_size = cards[index];
+    guint32 true_n = 0;
+    for (guint j = 2; j < card_size + 2; j++)
+      if ((cards[index+j] > 0) == v[std::abs (cards[index+j])-1])
+        true_n++;
+    if (true_n > guint32 (cards[index+1]))
+      return false;
+    index += card_size + 2;
+  }
+
+  index = 0;
+  for (guint32 i = 0; i < pbs_n; i++)
+  {
+    gint64 terms_n = pbs[index];
+    gint64 sum = 0;
+    for (gint64 j = 0; j < terms_n; j++)
+    {
+      gint64 literal = pbs[index + 2*j + 3];
+      if ((literal > 0) == v[((literal > 0) ? literal : -literal)-1])
+        sum += pbs[index + 2*j + 2];
+    }
+    if (sum < pbs[index+1])
+      return false;
+    index += 2*terms_n + 2;
+  }
+  return true;
+}
+
+bool
+CNF::evaluate (const PackedAssignments& v, std::vector<guint64>& result) const
+{
+  const guint32 words_n = v.get_words_n ();
+  result.assign (words_n, G_MAXUINT64);
+  std::vector<guint64> clause_result (words_n);
+
+  gsize index = 0;
+  for (guint32 i = 0; i < clauses_n; i++)
+  {
+    guint32 clause_size = formulae[index];
+    std::fill (clause_result.begin (), clause_result.end (), 0);
+    for (guint j = 1; j <= clause_size; j++)
+    {
+      gint32 literal = formulae[index+j];
+      /* negated literal: xor with all ones */
+      guint64 neg = (literal > 0) ? 0 : G_MAXUINT64;
+      const guint64* words = v.var_words (((literal > 0) ? literal : -literal)-1);
+      for (guint32 w = 0; w < words_n; w++)
+        clause_result[w] |= words[w] ^ neg;
+    }
+
+    guint64 any = 0;
+    for (guint32 w = 0; w < words_n; w++)
+      any |= (result[w] &= clause_result[w]);
+    if (any == 0) /* if all assignments are false */
+      return false;
+    index += clause_size + 1;
+  }
+
+  index = 0;
+  for (guint32 i = 0; i < xors_n; i++)
+  {
+    guint32 xor_size = xors[index];
+    std::fill (clause_result.begin (), clause_result.end (), 0);
+    for (guint j = 1; j <= xor_size; j++)
+    {
+      gint32 literal = xors[index+j];
+      guint64 neg = (literal > 0) ? 0 : G_MAXUINT64;
+      const guint64* words = v.var_words (((literal > 0) ? literal : -literal)-1);
+      for (guint32 w = 0; w < words_n; w++)
+        clause_result[w] ^= words[w] ^ neg;
+    }
+
+    guint64 any = 0;
+    for (guint32 w = 0; w < words_n; w++)
+      any |= (result[w] &= clause_result[w]);
+    if (any == 0)
+      return false;
+    index += xor_size + 1;
+  }
+
+  index = 0;
+  for (guint32 i = 0; i < cards_n; i++)
+  {
+    guint32 card_size = cards[index];
+    guint32 bound = cards[index+1];
+    guint64 any = 0;
+    for (guint32 w = 0; w < words_n; w++)
+    {
+      guint64 card_result = 0;
+      for (guint32 b = 0; b < 64; b++)
+      {
+        guint32 true_n = 0;
+        for (guint j = 2; j < card_size + 2; j++)
+        {
+          gint32 literal = cards[index+j];
+          guint64 value = v.var_words (((literal > 0) ? literal : -literal)-1)[w];
+          if (((value >> b) & 1) == ((literal > 0) ? 1U : 0U))
+            true_n++;
+        }
+        if (true_n <= bound)
+          card_result |= 1ULL << b;
+      }
+      any |= (result[w] &= card_result);
+    }
+    if (any == 0)
+      return false;
+    index += card_size + 2;
+  }
+
+  index = 0;
+  for (guint32 i = 0; i < pbs_n; i++)
+  {
+    gint64 terms_n = pbs[index];
+    guint64 any = 0;
+    for (guint32 w = 0; w < words_n; w++)
+    {
+      guint64 pb_result = 0;
+      for (guint32 b = 0; b < 64; b++)
+      {
+        gint64 sum = 0;
+        for (gint64 j = 0; j < terms_n; j++)
+        {
+          gint64 literal = pbs[index + 2*j + 3];
+          guint64 value = v.var_words (((literal > 0) ? literal : -literal)-1)[w];
+          if (((value >> b) & 1) == ((literal > 0) ? 1U : 0U))
+            sum += pbs[index + 2*j + 2];
+        }
+        if (sum >= pbs[index+1])
+          pb_result |= 1ULL << b;
+      }
+      any |= (result[w] &= pb_result);
+    }
+    if (any == 0)
+      return false;
+    index += 2*terms_n + 2;
+  }
   return true;
 }
 
+guint64
+CNF::evaluate_cost (const std::vector<bool>& v) const
+{
+  guint64 cost = 0;
+  gsize index = 0;
+  for (guint32 i = 0; i < softs_n; i++)
+  {
+    guint32 clause_size = softs[index];
+    bool clause_result = false;
+    for (guint j = 1; j <= clause_size; j++)
+      if ((softs[index+j] > 0) == v[std::abs (softs[index+j])-1])
+      {
+        clause_result = true;
+        break;
+      }
+    if (!clause_result)
+      cost += soft_weights[i];
+    index += clause_size + 1;
+  }
+  return cost;
+}
+
 void
 CNF::clauses_indices (std::vector<guint32>& indices) const
 {
@@ -7,6 +7,7 @@
 #ifndef __MYSAT_SATUTILS_H__
 #define __MYSAT_SATUTILS_H__
 
+#include <iosfwd>
 #include <string>
 #include <vector>
 #include <glibmm.h>
@@ -37,14 +38,78 @@ public:
 typedef std::vector<gint32> LiteralVector;
 typedef std::vector<gint32>::iterator LiteralIter;
 typedef std::vector<gint32>::const_iterator LiteralConstIter;
+typedef std::vector<gint64> PBVector;
 
 LiteralVector get_literals_from_range (gint32 a, gint32 b);
 void add_literals_from_range (LiteralVector& v, gint32 a, gint32 b);
 
+/*
+ * packed (bit-sliced) assignments: values of one variable for many assignments
+ * are stored in words_n words, bit b of word w is value in assignment w*64+b.
+ */
+
+class PackedAssignments
+{
+private:
+  gint32 vars_n;
+  guint32 words_n;
+  std::vector<guint64> values;
+
+public:
+  PackedAssignments ();
+  /* models_n is rounded up to multiple of 64 */
+  PackedAssignments (gint32 vars_n, guint32 models_n);
+
+  void resize (gint32 vars_n, guint32 models_n);
+
+  gint32 get_vars_n () const
+  { return vars_n; }
+  guint32 get_words_n () const
+  { return words_n; }
+  guint32 get_models_n () const
+  { return words_n << 6; }
+
+  /* words with values of variable (var is index of variable from zero) */
+  guint64* var_words (gint32 var)
+  { return &values[var * words_n]; }
+  const guint64* var_words (gint32 var) const
+  { return &values[var * words_n]; }
+
+  bool get (guint32 model, gint32 var) const
+  { return (values[var * words_n + (model >> 6)] >> (model & 63)) & 1; }
+  void set (guint32 model, gint32 var, bool value);
+  /* set all values of variable to value */
+  void fill (gint32 var, bool value);
+
+  void set_model (guint32 model, const std::vector<bool>& v);
+  void get_model (guint32 model, std::vector<bool>& v) const;
+
+  /* fill with pseudorandom values (xorshift generator) */
+  void randomize (guint64 seed);
+};
+
 /*
  * structure of formulae:
  * clause_size [literal [literal]] clause_size [literal [literal]]
  * clause_size [literal [literal]] clause_size [literal [literal]] ...
+ *
+ * XOR constraints (lines 'x' in DIMACS) are stored in same form. XOR is
+ * satisfied if odd number of its literals is true.
+ *
+ * cardinality constraints (lines 'l1 l2 ... <= k' and '>= k' in CNF+) are
+ * stored as at most constraints: size bound [literal [literal]] ...
+ *
+ * pseudo-Boolean constraints (from OPB files) are stored as:
+ * size bound [coefficient literal] ..., sum of coefficients (positive)
+ * of true literals must be at least bound. formulae with pseudo-Boolean
+ * constraints is saved in OPB format (without XORs).
+ *
+ * projection (variables shown in models) is read from 'c p show' or 'c ind'
+ * comment lines and saved as 'c p show' line. empty projection - all variables.
+ *
+ * soft clauses (from WCNF files) are stored in same form as clauses,
+ * their weights in separate vector. weight is cost of model which doesn't
+ * satisfy soft clause. formulae with soft clauses is saved in WCNF format.
  */
 
 class CNF
@@ -53,6 +118,25 @@ private:
   gint32 vars_n;
   guint32 clauses_n;
   LiteralVector formulae;
+  guint32 xors_n;
+  LiteralVector xors;
+  guint32 cards_n;
+  LiteralVector cards;
+  guint32 pbs_n;
+  PBVector pbs;
+  LiteralVector projection;
+  guint32 softs_n;
+  LiteralVector softs;
+  std::vector<guint64> soft_weights;
+
+  /* add clauses equivalent to XOR of literals */
+  void add_xor_clauses (const LiteralVector& literals);
+  /* OPB format */
+  void load_opb (std::istream& is);
+  void save_opb (std::ostream& os) const;
+  /* WCNF format (problem_line is empty if file has not problem line) */
+  void load_wcnf (std::istream& is, const std::string& problem_line);
+  void save_wcnf (std::ostream& os) const;
 
 public:
   CNF ();
@@ -74,12 +158,23 @@ public:
   { return clauses_n; }
   guint32 get_literals_n () const
   { return formulae.size () - clauses_n; }
+  guint32 get_xors_n () const
+  { return xors_n; }
+  guint32 get_cards_n () const
+  { return cards_n; }
+  guint32 get_pbs_n () const
+  { return pbs_n; }
+  guint32 get_softs_n () const
+  { return softs_n; }
 
   gint32 add_var ();
   void add_vars (gint32 vars_n);
   LiteralVector add_vars_with_literals (gint32 vars_n);
   void resize (gint32 vars_n, guint32 clauses_n);
   bool check_consistency () const;
+  /* sort literals of clauses and remove repeated literals (required by
+   * solvers) */
+  void normalize_clauses ();
 
   LiteralIter begin ()
   { return formulae.begin (); }
@@ -96,6 +191,33 @@ public:
   const LiteralVector& get_formulae () const
   { return formulae; }
 
+  LiteralVector& get_xors ()
+  { return xors; }
+  const LiteralVector& get_xors () const
+  { return xors; }
+
+  LiteralVector& get_cards ()
+  { return cards; }
+  const LiteralVector& get_cards () const
+  { return cards; }
+
+  PBVector& get_pbs ()
+  { return pbs; }
+  const PBVector& get_pbs () const
+  { return pbs; }
+
+  LiteralVector& get_projection ()
+  { return projection; }
+  const LiteralVector& get_projection () const
+  { return projection; }
+
+  LiteralVector& get_softs ()
+  { return softs; }
+  const LiteralVector& get_softs () const
+  { return softs; }
+  const std::vector<guint64>& get_soft_weights () const
+  { return soft_weights; }
+
   void clear ();
 
   /* add clause with literals: ignore '0' literals */
@@ -107,7 +229,39 @@ public:
   void add_clause (gint32 l1, gint32 l2, gint32 l3);
   void add_clause (gint32 l1, gint32 l2, gint32 l3, gint32 l4);
 
+  /* add XOR of literals: ignore '0' literals */
+  void add_xor (const LiteralVector& literals);
+  /* replace XORs by clauses (long XORs are cut by new variables) */
+  void xors_to_clauses ();
+
+  /* add constraint: at most (at least) bound literals are true */
+  void add_at_most (const LiteralVector& literals, guint32 bound);
+  void add_at_least (const LiteralVector& literals, guint32 bound);
+  /* replace cardinality constraints by clauses (sequential counters) */
+  void cards_to_clauses ();
+
+  /* add constraint: sum of coefficients (any sign) of true literals
+   * is at least (at most, equal to) bound */
+  void add_pb_at_least (const PBVector& coefs, const LiteralVector& literals,
+        gint64 bound);
+  void add_pb_at_most (const PBVector& coefs, const LiteralVector& literals,
+        gint64 bound);
+  void add_pb_equal (const PBVector& coefs, const LiteralVector& literals,
+        gint64 bound);
+  /* replace pseudo-Boolean constraints by clauses (decision diagrams,
+   * or adders if diagram is too big) */
+  void pbs_to_clauses ();
+
+  /* add soft clause: ignore '0' literals */
+  void add_soft_clause (const LiteralVector& literals, guint64 weight);
+
   bool evaluate (const std::vector<bool>& v) const;
+  /* evaluate formulae for all packed assignments at once:
+   * result - bit per assignment (set if formulae is satisfied),
+   * returns true if any assignment satisfies formulae */
+  bool evaluate (const PackedAssignments& v, std::vector<guint64>& result) const;
+  /* sum of weights of soft clauses not satisfied by assignment */
+  guint64 evaluate_cost (const std::vector<bool>& v) const;
 
   void clauses_indices (std::vector<guint32>& indices) const;
 };
@@ -265,6 +419,13 @@ public:
   std::string get_module_params_info_string () const;
 };
 
+/* outmap: print values given by conversions in outmap for model (instance)
+ * to output. returns false if outmap has bad format */
+bool print_output_based_on_outmap (std::istream& outmap,
+      const std::vector<bool>& instance, bool sat, std::ostream& os);
+/* variables used in conversions of outmap (sorted, without repeats) */
+bool get_outmap_variables (std::istream& outmap, LiteralVector& vars);
+
 };
 
 #endif /* __MYSAT_SATUTILS_H__ */
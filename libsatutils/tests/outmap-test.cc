@@ -0,0 +1,91 @@
+/*
+ * outmap-test.cc - testing printing values based on outmap
+ * Author: Mateusz Szpakowski
+ * License: LGPL v2.0
+ */
+
+#include <iostream>
+#include <sstream>
+#include <glibmm.h>
+#include <satutils.h>
+
+using namespace SatUtils;
+
+static const char* outmap_string =
+    "a={u:1 2 -3} b={s:4 5}\\{\\} c={x:6 7 8 9} d={o:1 2 3 4 5 6}\n"
+    "e={{zero|one|t\\|wo}:3 -10}\n";
+
+static bool
+outmap_print_test ()
+{
+  std::cout << "Printing values based on outmap" << std::endl;
+  /* variables 1..10 */
+  static const bool values[] = { true, false, false, true, true,
+      true, false, true, true, false };
+  std::vector<bool> instance (values, values + 10);
+  std::istringstream outmap (outmap_string);
+  std::ostringstream os;
+  if (!print_output_based_on_outmap (outmap, instance, true, os))
+    return false;
+  if (os.str () != "a=5 b=-1{} c=d d=71\ne=t|wo\n")
+  {
+    std::cerr << "Bad output: " << os.str () << std::endl;
+    return false;
+  }
+
+  std::cout << "Printing bad outmap" << std::endl;
+  static const char* bad_outmaps[] = { "{q:1}", "{u 1}", "{u:1 2",
+      "{{a|b:1}", "{u:1 x}", "{u:0}" };
+  for (guint i = 0; i < sizeof (bad_outmaps) / sizeof (const char*); i++)
+  {
+    std::istringstream bad (bad_outmaps[i]);
+    std::ostringstream bados;
+    if (print_output_based_on_outmap (bad, instance, true, bados))
+      return false;
+  }
+  return true;
+}
+
+static bool
+outmap_variables_test ()
+{
+  std::cout << "Getting variables of outmap" << std::endl;
+  std::istringstream outmap (outmap_string);
+  LiteralVector vars;
+  if (!get_outmap_variables (outmap, vars))
+    return false;
+  static const gint32 expected[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+  if (vars != LiteralVector (expected, expected + 10))
+    return false;
+
+  std::istringstream escaped ("\\{u:1} {x:-7 3 -3}");
+  if (!get_outmap_variables (escaped, vars))
+    return false;
+  static const gint32 expected2[] = { 3, 7 };
+  if (vars != LiteralVector (expected2, expected2 + 2))
+    return false;
+
+  std::istringstream bad ("{u:1 2");
+  if (get_outmap_variables (bad, vars))
+    return false;
+  return true;
+}
+
+int
+main (int argc, char** argv)
+{
+  Glib::init ();
+
+  if (!outmap_print_test ())
+  {
+    std::cerr << "Outmap printing failed" << std::endl;
+    return 1;
+  }
+  if (!outmap_variables_test ())
+  {
+    std::cerr << "Outmap variables failed" << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
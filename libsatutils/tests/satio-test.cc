@@ -6,6 +6,7 @@
 
 #include <iostream>
 #include <cstdio>
+#include <fstream>
 #include <glibmm.h>
 #include <satutils.h>
 
@@ -133,8 +134,413 @@ cnf_eval_test ()
   return true;
 }
 
+static bool
+cnf_normalize_test ()
+{
+  std::cout << "Testing normalization of clauses" << std::endl;
+  
+  static const gint32 expected[] = { 2, -1, 3, 1, 2, 3, -3, 1, 2 };
+  CNF cnf;
+  cnf.add_vars (3);
+  cnf.add_clause (3, -1, 3);
+  cnf.add_clause (2, 2);
+  cnf.add_clause (2, -3, 1, -3);
+  cnf.normalize_clauses ();
+  if (cnf.get_clauses_n () != 3 || !cnf.check_consistency () ||
+      cnf.get_formulae () != LiteralVector (expected, expected + 9))
+    return false;
+  
+  return true;
+}
+
+static bool
+cnf_projection_test ()
+{
+  std::cout << "Loading and saving CNF with projection" << std::endl;
+  {
+    std::ofstream file ("proj.cnf");
+    file << "c p show 3 1 0\np cnf 4 2\n1 -2 0\nc ind 4 1 0\n3 4 0\n";
+  }
+  CNF cnf ("proj.cnf");
+  remove ("proj.cnf");
+  static const gint32 expected[] = { 1, 3, 4 };
+  if (cnf.get_clauses_n () != 2 ||
+      cnf.get_projection () != LiteralVector (expected, expected + 3))
+    return false;
+  cnf.save_to_file ("proj2.cnf");
+  CNF cnf2 ("proj2.cnf");
+  remove ("proj2.cnf");
+  if (cnf != cnf2)
+    return false;
+  
+  return true;
+}
+
+static bool
+cnf_trailing_projection_test ()
+{
+  std::cout << "Loading CNF with projection after last clause" << std::endl;
+  {
+    std::ofstream file ("proj.cnf");
+    file << "p cnf 5 2\n1 -2 0\n3 4 0\nc p show 5 2 0\n\nc ind 3 0\n";
+  }
+  CNF cnf ("proj.cnf");
+  remove ("proj.cnf");
+  static const gint32 expected[] = { 2, 3, 5 };
+  if (cnf.get_clauses_n () != 2 ||
+      cnf.get_projection () != LiteralVector (expected, expected + 3))
+    return false;
+  
+  return true;
+}
+
+static bool
+cnf_packed_eval_test ()
+{
+  std::cout << "Testing packed evaluation of CNF with 5 variables" << std::endl;
+  
+  CNF cnf;
+  cnf.add_vars (5);
+  cnf.add_clause (3, 5, -1, 2);
+  cnf.add_clause (2, -5, 4);
+  cnf.add_clause (-3, 1, 2, 4);
+  cnf.add_clause (5, -3, -1);
+  
+  /* all 32 assignments in 4 words (256 assignments), repeated */
+  PackedAssignments packed (5, 256);
+  for (guint32 m = 0; m < packed.get_models_n (); m++)
+    for (gint32 v = 0; v < 5; v++)
+      packed.set (m, v, (m & (1U << v)) != 0);
+  
+  std::vector<guint64> result;
+  if (!cnf.evaluate (packed, result))
+    return false;
+  for (guint32 m = 0; m < packed.get_models_n (); m++)
+  {
+    std::vector<bool> model;
+    packed.get_model (m, model);
+    if (((result[m >> 6] >> (m & 63)) & 1) != guint64 (cnf.evaluate (model)))
+      return false;
+  }
+  
+  std::cout << "Testing packed evaluation of unsatisfied CNF" << std::endl;
+  cnf.add_clause (1);
+  cnf.add_clause (-1);
+  packed.randomize (1);
+  if (cnf.evaluate (packed, result))
+    return false;
+  
+  return true;
+}
+
+static bool
+cnf_xor_test ()
+{
+  std::cout << "Loading and saving CNF with XORs" << std::endl;
+  {
+    std::ofstream file ("xor.cnf");
+    file << "c test\np cnf 6 4\n1 2 0\nx1 -3 4 0\nc comment\n"
+        "x 2 -5 6 3 1 2 0\n-1 -6 0\n";
+  }
+  CNF cnf ("xor.cnf");
+  remove ("xor.cnf");
+  if (cnf.get_clauses_n () != 2 || cnf.get_xors_n () != 2 ||
+      !cnf.check_consistency ())
+    return false;
+  cnf.save_to_file ("xor2.cnf");
+  CNF cnf2 ("xor2.cnf");
+  remove ("xor2.cnf");
+  if (cnf != cnf2)
+    return false;
+
+  std::cout << "Testing evaluation of XORs" << std::endl;
+  static const bool input_values1[] = { true, false, false, true, true, false };
+  static const bool input_values2[] = { true, false, true, false, true, false };
+  if (!cnf.evaluate (std::vector<bool>(input_values1, input_values1 + 6)))
+    return false;
+  if (cnf.evaluate (std::vector<bool>(input_values2, input_values2 + 6)))
+    return false;
+
+  std::cout << "Testing conversion of XORs to clauses" << std::endl;
+  CNF xcnf;
+  xcnf.add_vars (6);
+  LiteralVector xor_literals = get_literals_from_range (1, 7);
+  xor_literals[2] = -3;
+  xcnf.add_xor (xor_literals);
+  cnf2 = xcnf;
+  cnf2.xors_to_clauses ();
+  if (cnf2.get_xors_n () != 0 || !cnf2.check_consistency ())
+    return false;
+  const gint32 vars_n = cnf2.get_vars_n ();
+  for (guint32 m = 0; m < 64; m++)
+  {
+    std::vector<bool> model (vars_n);
+    for (gint32 v = 0; v < 6; v++)
+      model[v] = (m & (1U << v)) != 0;
+    /* clauses must be satisfiable by some values of new variables */
+    bool satisfied = false;
+    for (guint32 e = 0; e < (1U << (vars_n - 6)) && !satisfied; e++)
+    {
+      for (gint32 v = 6; v < vars_n; v++)
+        model[v] = (e & (1U << (v-6))) != 0;
+      satisfied = cnf2.evaluate (model);
+    }
+    if (satisfied != xcnf.evaluate (model))
+      return false;
+  }
+
+  std::cout << "Testing packed evaluation of XORs" << std::endl;
+  PackedAssignments packed (6, 64);
+  for (guint32 m = 0; m < 64; m++)
+    for (gint32 v = 0; v < 6; v++)
+      packed.set (m, v, (m & (1U << v)) != 0);
+  std::vector<guint64> result;
+  xcnf.evaluate (packed, result);
+  for (guint32 m = 0; m < 64; m++)
+  {
+    std::vector<bool> model;
+    packed.get_model (m, model);
+    if (((result[0] >> m) & 1) != guint64 (xcnf.evaluate (model)))
+      return false;
+  }
+  return true;
+}
+
+static bool
+cnf_card_test ()
+{
+  std::cout << "Loading and saving CNF with cardinality constraints" << std::endl;
+  {
+    std::ofstream file ("card.cnf");
+    file << "c test\np cnf+ 6 3\n1 2 0\n1 -3 4 5 <= 2\n2 3 6 >= 2\n";
+  }
+  CNF cnf ("card.cnf");
+  remove ("card.cnf");
+  if (cnf.get_clauses_n () != 1 || cnf.get_cards_n () != 2 ||
+      !cnf.check_consistency ())
+    return false;
+  cnf.save_to_file ("card2.cnf");
+  CNF cnf2 ("card2.cnf");
+  remove ("card2.cnf");
+  if (cnf != cnf2)
+    return false;
+
+  std::cout << "Loading CNF with too big bound of cardinality" << std::endl;
+  {
+    std::ofstream file ("card.cnf");
+    file << "p cnf+ 3 2\n1 2 0\n2 -3 >= 3\n";
+  }
+  try
+  {
+    CNF bad_cnf ("card.cnf");
+    remove ("card.cnf");
+    return false;
+  }
+  catch (const CNFError& ex)
+  {
+    remove ("card.cnf");
+    if (ex.code () != CNFError::BAD_FORMAT)
+      return false;
+  }
+
+  std::cout << "Testing evaluation of cardinality constraints" << std::endl;
+  static const bool input_values1[] = { true, true, true, false, true, false };
+  static const bool input_values2[] = { true, true, false, true, true, false };
+  static const bool input_values3[] = { true, false, true, false, false, false };
+  if (!cnf.evaluate (std::vector<bool>(input_values1, input_values1 + 6)))
+    return false;
+  if (cnf.evaluate (std::vector<bool>(input_values2, input_values2 + 6)))
+    return false;
+  if (cnf.evaluate (std::vector<bool>(input_values3, input_values3 + 6)))
+    return false;
+
+  std::cout << "Testing conversion and packed evaluation of "
+      "cardinality constraints" << std::endl;
+  for (guint32 bound = 0; bound <= 6; bound++)
+  {
+    CNF ccnf;
+    ccnf.add_vars (5);
+    LiteralVector card_literals = get_literals_from_range (1, 6);
+    card_literals[1] = -2;
+    if (bound < 6)
+      ccnf.add_at_most (card_literals, bound);
+    else
+      ccnf.add_at_least (card_literals, 3);
+    cnf2 = ccnf;
+    cnf2.cards_to_clauses ();
+    if (cnf2.get_cards_n () != 0 || !cnf2.check_consistency ())
+      return false;
+    const gint32 vars_n = cnf2.get_vars_n ();
+    for (guint32 m = 0; m < 32; m++)
+    {
+      std::vector<bool> model (vars_n);
+      for (gint32 v = 0; v < 5; v++)
+        model[v] = (m & (1U << v)) != 0;
+      bool satisfied = false;
+      for (guint32 e = 0; e < (1U << (vars_n - 5)) && !satisfied; e++)
+      {
+        for (gint32 v = 5; v < vars_n; v++)
+          model[v] = (e & (1U << (v-5))) != 0;
+        satisfied = cnf2.evaluate (model);
+      }
+      if (satisfied != ccnf.evaluate (model))
+        return false;
+    }
+
+    PackedAssignments packed (5, 32);
+    for (guint32 m = 0; m < 32; m++)
+      for (gint32 v = 0; v < 5; v++)
+        packed.set (m, v, (m & (1U << v)) != 0);
+    std::vector<guint64> result;
+    ccnf.evaluate (packed, result);
+    for (guint32 m = 0; m < 32; m++)
+    {
+      std::vector<bool> model;
+      packed.get_model (m, model);
+      if (((result[0] >> m) & 1) != guint64 (ccnf.evaluate (model)))
+        return false;
+    }
+  }
+  return true;
+}
+
+static bool
+cnf_pb_test ()
+{
+  std::cout << "Loading and saving OPB" << std::endl;
+  {
+    std::ofstream file ("pb.opb");
+    file << "* #variable= 5 #constraint= 4\n* comment\nmin: +1 x1 ;\n"
+        "+2 x1 -3 ~x2 +1 x3 >= 1 ;\n+1 x4 +1 x5\n <= 1 ;\n"
+        "+5 x1 +3 x2 +2 x3 +1 x4 = 6;\n";
+  }
+  CNF cnf ("pb.opb");
+  remove ("pb.opb");
+  if (cnf.get_vars_n () != 5 || cnf.get_clauses_n () != 0 ||
+      cnf.get_pbs_n () != 4 || !cnf.check_consistency ())
+    return false;
+  cnf.save_to_file ("pb2.opb");
+  CNF cnf2 ("pb2.opb");
+  remove ("pb2.opb");
+  if (cnf != cnf2)
+    return false;
+
+  std::cout << "Testing evaluation of pseudo-Boolean constraints" << std::endl;
+  static const bool input_values1[] = { true, false, true, false, true };
+  static const bool input_values2[] = { false, true, true, true, false };
+  static const bool input_values3[] = { false, true, true, true, true };
+  static const bool input_values4[] = { true, false, false, true, false };
+  if (cnf.evaluate (std::vector<bool>(input_values1, input_values1 + 5)))
+    return false;
+  if (!cnf.evaluate (std::vector<bool>(input_values2, input_values2 + 5)))
+    return false;
+  if (cnf.evaluate (std::vector<bool>(input_values3, input_values3 + 5)))
+    return false;
+  if (cnf.evaluate (std::vector<bool>(input_values4, input_values4 + 5)))
+    return false;
+
+  std::cout << "Testing conversion and packed evaluation of "
+      "pseudo-Boolean constraints" << std::endl;
+  cnf.add_clause (-1, 2);
+  cnf.add_at_most (get_literals_from_range (2, 5), 2);
+  cnf2 = cnf;
+  cnf2.pbs_to_clauses ();
+  if (cnf2.get_pbs_n () != 0 || !cnf2.check_consistency ())
+    return false;
+  /* OPB with clauses and cardinality constraints */
+  cnf.save_to_file ("pb3.opb");
+  CNF cnf3 ("pb3.opb");
+  remove ("pb3.opb");
+  const gint32 vars_n = cnf2.get_vars_n ();
+  PackedAssignments packed (5, 32);
+  for (guint32 m = 0; m < 32; m++)
+  {
+    std::vector<bool> model (vars_n);
+    for (gint32 v = 0; v < 5; v++)
+    {
+      model[v] = (m & (1U << v)) != 0;
+      packed.set (m, v, model[v]);
+    }
+    bool satisfied = false;
+    for (guint32 e = 0; e < (1U << (vars_n - 5)) && !satisfied; e++)
+    {
+      for (gint32 v = 5; v < vars_n; v++)
+        model[v] = (e & (1U << (v-5))) != 0;
+      satisfied = cnf2.evaluate (model);
+    }
+    model.resize (5);
+    if (satisfied != cnf.evaluate (model) ||
+        satisfied != cnf3.evaluate (model))
+      return false;
+  }
+  std::vector<guint64> result;
+  cnf.evaluate (packed, result);
+  for (guint32 m = 0; m < 32; m++)
+  {
+    std::vector<bool> model;
+    packed.get_model (m, model);
+    if (((result[0] >> m) & 1) != guint64 (cnf.evaluate (model)))
+      return false;
+  }
+  return true;
+}
+
 /* main function */
 
+static bool
+cnf_wcnf_test ()
+{
+  std::cout << "Loading and saving WCNF" << std::endl;
+  {
+    std::ofstream file ("w.wcnf");
+    file << "c comment\np wcnf 3 4 10\n10 1 2 0\n3 -1 0\n10 -2 3\n 0\n"
+        "5 -3 0\n";
+  }
+  CNF cnf ("w.wcnf");
+  remove ("w.wcnf");
+  if (cnf.get_vars_n () != 3 || cnf.get_clauses_n () != 2 ||
+      cnf.get_softs_n () != 2 || cnf.get_soft_weights ()[1] != 5)
+    return false;
+  cnf.save_to_file ("w2.wcnf");
+  CNF cnf2 ("w2.wcnf");
+  remove ("w2.wcnf");
+  if (cnf != cnf2)
+    return false;
+  /* format without problem line */
+  {
+    std::ofstream file ("w3.wcnf");
+    file << "c comment\nh 1 2 0\n3 -1 0\nh -2 3 0\n5 -3 0\n";
+  }
+  CNF cnf3 ("w3.wcnf");
+  remove ("w3.wcnf");
+  if (cnf != cnf3)
+    return false;
+  /* without problem line and comments: starts with soft clause */
+  {
+    std::ofstream file ("w4.wcnf");
+    file << "3 -1 0\nh 1 2 0\nh -2 3 0\n5 -3 0\n";
+  }
+  CNF cnf4 ("w4.wcnf");
+  remove ("w4.wcnf");
+  if (cnf != cnf4)
+    return false;
+
+  std::cout << "Testing cost of soft clauses" << std::endl;
+  static const bool input_values1[] = { true, false, false };
+  static const bool input_values2[] = { true, true, true };
+  static const bool input_values3[] = { false, true, true };
+  if (cnf.evaluate_cost (std::vector<bool>(input_values1, input_values1 + 3))
+      != 3)
+    return false;
+  if (cnf.evaluate_cost (std::vector<bool>(input_values2, input_values2 + 3))
+      != 8)
+    return false;
+  if (cnf.evaluate_cost (std::vector<bool>(input_values3, input_values3 + 3))
+      != 5)
+    return false;
+  return true;
+}
+
 int
 main (int argc, char** argv)
 {
@@ -152,6 +558,46 @@ main (int argc, char** argv)
       std::cerr << "CNF evaluation is failed" << std::endl;
       return 1;
     }
+    if (!cnf_normalize_test ())
+    {
+      std::cerr << "CNF normalization is failed" << std::endl;
+      return 1;
+    }
+    if (!cnf_projection_test ())
+    {
+      std::cerr << "CNF projection is failed" << std::endl;
+      return 1;
+    }
+    if (!cnf_trailing_projection_test ())
+    {
+      std::cerr << "CNF projection after clauses is failed" << std::endl;
+      return 1;
+    }
+    if (!cnf_packed_eval_test ())
+    {
+      std::cerr << "CNF packed evaluation is failed" << std::endl;
+      return 1;
+    }
+    if (!cnf_xor_test ())
+    {
+      std::cerr << "CNF XORs are failed" << std::endl;
+      return 1;
+    }
+    if (!cnf_card_test ())
+    {
+      std::cerr << "CNF cardinality constraints are failed" << std::endl;
+      return 1;
+    }
+    if (!cnf_pb_test ())
+    {
+      std::cerr << "CNF pseudo-Boolean constraints are failed" << std::endl;
+      return 1;
+    }
+    if (!cnf_wcnf_test ())
+    {
+      std::cerr << "CNF soft clauses are failed" << std::endl;
+      return 1;
+    }
   }
   catch (Glib::Exception& ex)
   {
@@ -0,0 +1,354 @@
+/*
+ * approx-count.cc - approximate model counting by random XOR hashing
+ * Author: Mateusz Szpakowski
+ * License: LGPL v2.0
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <sstream>
+#include <glibmm.h>
+#include "approx-count.h"
+
+namespace
+{
+
+/* log2 of estimate, empty cells are smallest */
+double
+estimate_log2 (const ApproxCount& count)
+{
+  if (count.cell_models == 0)
+    return -1.0;
+  return std::log (double (count.cell_models)) / std::log (2.0) +
+      count.hashes_n;
+}
+
+bool
+estimate_less (const ApproxCount& c1, const ApproxCount& c2)
+{
+  return estimate_log2 (c1) < estimate_log2 (c2);
+}
+
+};
+
+std::string
+ApproxCount::to_string () const
+{
+  /* decimal digits from least significant */
+  std::vector<guint8> digits;
+  guint64 value = cell_models;
+  do
+  {
+    digits.push_back (value % 10);
+    value /= 10;
+  } while (value != 0);
+
+  for (guint32 i = 0; i < hashes_n; i++)
+  {
+    guint8 carry = 0;
+    for (std::vector<guint8>::iterator it = digits.begin ();
+         it != digits.end (); ++it)
+    {
+      guint8 digit = (*it << 1) + carry;
+      *it = digit % 10;
+      carry = digit / 10;
+    }
+    if (carry != 0)
+      digits.push_back (carry);
+  }
+
+  std::string str;
+  for (std::vector<guint8>::reverse_iterator it = digits.rbegin ();
+       it != digits.rend (); ++it)
+    str += char ('0' + *it);
+  return str;
+}
+
+double
+ApproxCount::log10 () const
+{
+  return std::log10 (double (cell_models)) + hashes_n * std::log10 (2.0);
+}
+
+ApproxCounter::ApproxCounter (MySatModuleCreateCallback create_callback,
+      const std::string& params)
+    : create (create_callback), module_params (params), epsilon (0.8),
+      delta (0.2), seed (1), random_state (1), current (0), interrupted (0),
+      stop_reason (0)
+{
+}
+
+void
+ApproxCounter::set_tolerance (double new_epsilon, double new_delta)
+{
+  if (new_epsilon <= 0.0)
+    throw ModuleError (ModuleError::BAD_VALUE,
+          "Tolerance epsilon must be positive");
+  if (new_delta <= 0.0 || new_delta >= 1.0)
+    throw ModuleError (ModuleError::BAD_VALUE,
+          "Confidence delta must be in range (0,1)");
+  epsilon = new_epsilon;
+  delta = new_delta;
+}
+
+guint32
+ApproxCounter::get_threshold () const
+{
+  double factor = 1.0 + 1.0/epsilon;
+  return guint32 (1.0 + 9.84 * (1.0 + epsilon/(1.0 + epsilon)) *
+        factor * factor);
+}
+
+guint32
+ApproxCounter::get_iterations_n () const
+{
+  return guint32 (std::ceil (17.0 * std::log (3.0/delta) / std::log (2.0)));
+}
+
+void
+ApproxCounter::interrupt ()
+{
+  g_atomic_int_set (&interrupted, 1);
+  MySatModule* solver = current;
+  if (solver != 0)
+    solver->interrupt ();
+}
+
+bool
+ApproxCounter::random_bit ()
+{
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 7;
+  random_state ^= random_state << 17;
+  return (random_state >> 32) & 1;
+}
+
+MySatModule*
+ApproxCounter::new_solver (const CNF& cnf)
+{
+  std::auto_ptr<MySatModule> solver (create ());
+  if (!solver->set_incremental ())
+    throw ModuleError (ModuleError::OTHER_ERROR,
+          "Module doesnt support incremental solving");
+  if (module_params.size () != 0)
+    solver->parse_params (module_params);
+  solver->fetch_problem (cnf);
+  return solver.release ();
+}
+
+bool
+ApproxCounter::count_cell (MySatModule& solver,
+      const LiteralVector& projection, const std::vector<gint32>& assumptions,
+      gint32 query_var, guint32 limit, guint32& models_n)
+{
+  std::vector<bool> model;
+  LiteralVector blocking;
+  models_n = 0;
+  while (models_n < limit)
+  {
+    if (g_atomic_int_get (&interrupted))
+    {
+      stop_reason = "interrupted";
+      return false;
+    }
+    /* time limits whole counting, other limits every solve */
+    SolverBudget solve_budget = budget;
+    if (budget.time != 0)
+    {
+      solve_budget.time = budget.time - timer.elapsed ();
+      if (solve_budget.time <= 0.0)
+      {
+        stop_reason = "time";
+        return false;
+      }
+    }
+    solver.set_budget (solve_budget);
+    solver.set_assumptions (assumptions);
+
+    Result result = solver.solve (model);
+    if (result == UNKNOWN)
+    {
+      stop_reason = solver.get_stop_reason ();
+      return false;
+    }
+    if (result == UNSATISFIABLE)
+      break;
+    models_n++;
+    /* blocking clause is active only in this query */
+    blocking.assign (1, query_var);
+    for (LiteralConstIter it = projection.begin (); it != projection.end ();
+         ++it)
+      blocking.push_back ((model[*it-1]) ? -*it : *it);
+    solver.add_clause (blocking);
+  }
+  /* disable blocking clauses of this query */
+  solver.add_clause (LiteralVector (1, query_var));
+  return true;
+}
+
+bool
+ApproxCounter::count_hashed (const CNF& cnf, const LiteralVector& projection,
+      guint32 hashes_n, guint32 hint, ApproxCount& estimate)
+{
+  /* hash i is active if its variable is false */
+  CNF hashed_cnf (cnf);
+  const gint32 hash_vars = cnf.next_var ();
+  const gint32 query_vars = hash_vars + hashes_n;
+  /* binary search with hint needs at most this queries */
+  guint32 queries_max = 2;
+  while ((guint64 (1) << (queries_max-2)) <= hashes_n)
+    queries_max++;
+  hashed_cnf.add_vars (hashes_n + queries_max);
+
+  LiteralVector xor_literals;
+  for (guint32 i = 0; i < hashes_n; i++)
+  {
+    xor_literals.clear ();
+    for (LiteralConstIter it = projection.begin (); it != projection.end ();
+         ++it)
+      if (random_bit ())
+        xor_literals.push_back (*it);
+    xor_literals.push_back (hash_vars + i);
+    /* random parity: negated literal makes parity even */
+    if (random_bit ())
+      xor_literals[0] = -xor_literals[0];
+    hashed_cnf.add_xor (xor_literals);
+  }
+
+  std::auto_ptr<MySatModule> solver (new_solver (hashed_cnf));
+  current = solver.get ();
+
+  const guint32 threshold = get_threshold ();
+  std::vector<gint32> assumptions;
+  /* cell without hashes is too big (checked before) */
+  guint32 low = 0, high = hashes_n + 1;
+  guint32 high_models_n = 0;
+  guint32 tested = (hint > low && hint < high) ? hint : (low + high) / 2;
+  for (guint32 query = 0; high - low > 1 && query < queries_max; query++)
+  {
+    assumptions.clear ();
+    for (guint32 i = 0; i < tested; i++)
+      assumptions.push_back (-(hash_vars + gint32 (i)));
+    const gint32 query_var = query_vars + query;
+    assumptions.push_back (-query_var);
+    guint32 models_n;
+    if (!count_cell (*solver, projection, assumptions, query_var, threshold,
+          models_n))
+    {
+      current = 0;
+      return false;
+    }
+    if (models_n < threshold)
+    {
+      high = tested;
+      high_models_n = models_n;
+    }
+    else
+      low = tested;
+    tested = (low + high) / 2;
+  }
+  current = 0;
+
+  estimate.cell_models = high_models_n;
+  estimate.hashes_n = high;
+  estimate.exact = false;
+  return true;
+}
+
+Result
+ApproxCounter::count (const CNF& input_cnf,
+      const LiteralVector& input_projection, ApproxCount& result)
+{
+  /* initial number of hashes added to solver, doubled if too small */
+  static const guint32 min_hashes_n = 16;
+
+  stop_reason = 0;
+  g_atomic_int_set (&interrupted, 0);
+  random_state = seed * 0x9e3779b97f4a7c15ULL + 0x2545f4914f6cdd1dULL;
+  if (random_state == 0)
+    random_state = 1;
+  timer.start ();
+  result = ApproxCount ();
+
+  CNF cnf (input_cnf);
+  cnf.normalize_clauses ();
+  const gint32 vars_n = cnf.get_vars_n ();
+  LiteralVector projection (input_projection);
+  for (LiteralConstIter it = projection.begin (); it != projection.end (); ++it)
+    if (*it <= 0 || *it > vars_n)
+      throw ModuleError (ModuleError::BAD_VALUE,
+            "Projected variable out of range");
+  if (projection.empty ())
+    for (gint32 var = 1; var <= vars_n; var++)
+      projection.push_back (var);
+
+  const guint32 threshold = get_threshold ();
+  const guint32 iterations_n = get_iterations_n ();
+  const guint32 hashes_max = projection.size ();
+  {
+    std::ostringstream os;
+    os << "Threshold: " << threshold << ", iterations: " << iterations_n <<
+        ", projected variables: " << hashes_max;
+    signal_progress_def.emit (os.str ());
+  }
+
+  /* small number of models is counted exactly */
+  {
+    CNF query_cnf (cnf);
+    const gint32 query_var = query_cnf.add_var ();
+    std::auto_ptr<MySatModule> solver (new_solver (query_cnf));
+    current = solver.get ();
+    guint32 models_n;
+    bool counted = count_cell (*solver, projection,
+          std::vector<gint32> (1, -query_var), query_var, threshold, models_n);
+    current = 0;
+    if (!counted)
+      return UNKNOWN;
+    if (models_n < threshold)
+    {
+      result.cell_models = models_n;
+      result.exact = true;
+      return (models_n != 0) ? SATISFIABLE : UNSATISFIABLE;
+    }
+  }
+
+  std::vector<ApproxCount> estimates;
+  guint32 last_hashes_n = 0;
+  for (guint32 iter = 0; iter < iterations_n; iter++)
+  {
+    guint32 hashes_n = std::min (hashes_max,
+          std::max (min_hashes_n, 2*last_hashes_n));
+    ApproxCount estimate;
+    while (true)
+    {
+      if (!count_hashed (cnf, projection, hashes_n, last_hashes_n, estimate))
+        return UNKNOWN;
+      if (estimate.hashes_n <= hashes_n || hashes_n == hashes_max)
+        break;
+      /* cell is too big with all hashes */
+      hashes_n = std::min (hashes_max, 2*hashes_n);
+    }
+    /* cell can be too big even with all hashes if hashes are dependent */
+    if (estimate.hashes_n > hashes_n)
+      continue;
+
+    estimates.push_back (estimate);
+    last_hashes_n = estimate.hashes_n;
+    std::ostringstream os;
+    os << "Iteration " << (iter+1) << "/" << iterations_n << ": " <<
+        estimate.cell_models << " models in cell, hashes: " <<
+        estimate.hashes_n;
+    signal_progress_def.emit (os.str ());
+  }
+
+  if (estimates.empty ())
+  {
+    stop_reason = "dependent hashes";
+    return UNKNOWN;
+  }
+  /* median of estimates */
+  std::sort (estimates.begin (), estimates.end (), estimate_less);
+  result = estimates[estimates.size () / 2];
+  return SATISFIABLE;
+}
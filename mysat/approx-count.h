@@ -0,0 +1,109 @@
+/*
+ * approx-count.h - approximate model counting by random XOR hashing
+ * Author: Mateusz Szpakowski
+ * License: LGPL v2.0
+ */
+
+#ifndef __MYSAT_APPROX_COUNT_H__
+#define __MYSAT_APPROX_COUNT_H__
+
+#include <glibmm.h>
+#include <string>
+#include <vector>
+#include <satutils.h>
+#include "modules-table.h"
+
+/* estimated number of models: cell_models * 2^hashes_n */
+struct ApproxCount
+{
+  guint64 cell_models;
+  guint32 hashes_n;
+  bool exact;
+
+  ApproxCount () : cell_models (0), hashes_n (0), exact (false)
+  { }
+
+  /* decimal representation of estimate */
+  std::string to_string () const;
+  double log10 () const;
+};
+
+/*
+ * ApproxCounter - ApproxMC-style counter. models (different on projection)
+ * are divided to cells by random XORs over projected variables and
+ * the number of hashes giving cell with less than threshold models is
+ * found by bounded enumeration. the estimate is within
+ * (1+epsilon) factor with probability at least 1-delta.
+ *
+ * every iteration uses one incremental solver (created by callback):
+ * all XORs are added before solving with activation variables and cells
+ * of all tested hash prefixes are counted under assumptions, so learned
+ * clauses are reused between cells.
+ */
+class ApproxCounter
+{
+private:
+  MySatModuleCreateCallback create;
+  std::string module_params;
+  SolverBudget budget;
+  double epsilon;
+  double delta;
+  guint64 seed;
+
+  guint64 random_state;
+  Glib::Timer timer;
+  MySatModule* volatile current;
+  volatile gint interrupted;
+  const char* stop_reason;
+
+  sigc::signal<void, const std::string&> signal_progress_def;
+
+  /* xorshift generator, same hashes for same seed */
+  bool random_bit ();
+
+  MySatModule* new_solver (const CNF& cnf);
+  /* count models of cell (up to limit), returns false if stopped */
+  bool count_cell (MySatModule& solver, const LiteralVector& projection,
+        const std::vector<gint32>& assumptions, gint32 query_var,
+        guint32 limit, guint32& models_n);
+  /*
+   * find smallest number of random hashes (from hashes_n) giving small cell,
+   * starting from hint. estimate.hashes_n is hashes_n+1 if cell with
+   * all hashes is too big. returns false if stopped.
+   */
+  bool count_hashed (const CNF& cnf, const LiteralVector& projection,
+        guint32 hashes_n, guint32 hint, ApproxCount& estimate);
+public:
+  ApproxCounter (MySatModuleCreateCallback create,
+        const std::string& module_params);
+
+  void set_budget (const SolverBudget& new_budget)
+  { budget = new_budget; }
+  /* throws ModuleError if values are out of range */
+  void set_tolerance (double epsilon, double delta);
+  void set_seed (guint64 new_seed)
+  { seed = new_seed; }
+
+  /* number of models in cell */
+  guint32 get_threshold () const;
+  guint32 get_iterations_n () const;
+
+  /*
+   * count models of formulae (all variables if projection is empty).
+   * returns SATISFIABLE or UNSATISFIABLE (no models) if count is found,
+   * UNKNOWN if counting is stopped.
+   */
+  Result count (const CNF& cnf, const LiteralVector& projection,
+        ApproxCount& result);
+
+  sigc::signal<void, const std::string&>& signal_progress ()
+  { return signal_progress_def; }
+
+  /* request stopping of counting (async-signal-safe) */
+  void interrupt ();
+  /* why count returned UNKNOWN (0 if not stopped) */
+  const char* get_stop_reason () const
+  { return stop_reason; }
+};
+
+#endif /* __MYSAT_APPROX_COUNT_H__ */
@@ -8,11 +8,13 @@
 #include <iostream>
 #include <glibmm.h>
 #include "bcp.h"
+#include "lit-scan.h"
 
 using namespace SatUtils;
 
 BoolConstraintPropagate::BoolConstraintPropagate (CNF& incnf, AssignVector& inassigns)
-    : cnf (incnf), assigns (inassigns), decision_level (0), before_unsatisfiable (false)
+    : cnf (incnf), assigns (inassigns), decision_level (0), before_unsatisfiable (false),
+      propagations_n (0), ticks_n (0)
 {
   gint32 vars_n = cnf.get_vars_n ();
   LiteralVector& form = cnf.get_formulae ();
@@ -78,6 +80,8 @@ BoolConstraintPropagate::do_propagate (gint32 literal)
     queue.pop_front ();
 
     WatchedList& wc = watched[lit2wi (-firstlit)];
+    propagations_n++;
+    ticks_n += 1 + wc.size ();
 
     if (assigns[lit2var (firstlit)].assigned ())
     {
@@ -116,21 +120,23 @@ BoolConstraintPropagate::do_propagate (gint32 literal)
       }
       else
       {
-	for (guint j = 2; j < cl_size; j++)
-	{
-	  gint32 lit = form[clidx+j];
-	  if (assigns.get (-lit)) /* if false literal */
-	    continue; /* skip false's */
-	  else
-	  { /* if other literal is free or true then is new watch */
-	    /*std::cout << "New watch: " << lit << ", clidx: " << clidx <<
-		",j: " << j << " old: " << form[clidx] << std::endl;*/
-	    guint32 wlit = lit2wi (lit);
-	    watched[wlit].push_back (clidx-1);
-	    std::swap (form[clidx], form[clidx+j]);
-	    if_newwatch = true;
-	    break;
-	  }
+	guint j;
+	if (cl_size - 2 >= lit_scan_min_size)
+	  j = 2 + lit_scan (&form[clidx+2], cl_size-2,
+		assigns.values (), 0);
+	else /* skip false's */
+	  for (j = 2; j < cl_size && assigns.get (-form[clidx+j]); j++);
+	/* next cache lines of clause (16 literals per line) */
+	ticks_n += (j - 2) >> 4;
+
+	if (j < cl_size)
+	{ /* if other literal is free or true then is new watch */
+	  /*std::cout << "New watch: " << lit << ", clidx: " << clidx <<
+	      ",j: " << j << " old: " << form[clidx] << std::endl;*/
+	  guint32 wlit = lit2wi (form[clidx+j]);
+	  watched[wlit].push_back (clidx-1);
+	  std::swap (form[clidx], form[clidx+j]);
+	  if_newwatch = true;
 	}
 
 	if (!if_newwatch)
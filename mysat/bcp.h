@@ -44,6 +44,11 @@ private:
 
   bool before_unsatisfiable;
 
+  /* work counters for budgets: propagated literals, watch list entries
+   * and cache lines of scanned clauses */
+  guint64 propagations_n;
+  guint64 ticks_n;
+
 public:
   BoolConstraintPropagate (CNF& cnf, AssignVector& inassigns);
 
@@ -63,6 +68,11 @@ public:
 
   bool is_before_unsatisfiable () const
   { return before_unsatisfiable; }
+
+  guint64 get_propagations_n () const
+  { return propagations_n; }
+  guint64 get_ticks_n () const
+  { return ticks_n; }
 };
 
 #endif /* _MYSAT_BCP_H_ */
@@ -12,24 +12,58 @@
 #include <sstream>
 #include <glibmm.h>
 #include "cdcl.h"
+#include "lit-scan.h"
 
 /* CDCL implementation */
 
 CDCLModule::CDCLModule ()
-    : learn_factor (0.2), learn_start(0), restart_strategy_string ("minisat"),
+    : learn_factor (0.2), learn_start(0), prefetch_dist (4), do_shrink (true),
+      do_otfs (true),
+      restart_strategy_string ("minisat"),
       restart_strategy (RESTARTS_MINISAT),
-      varlist (0), sorted_varlist (0), watched (0)
+      do_gauss (true), xor_detect (6), card_detect (8),
+      detected_xors_n (0), xor_clauses_n (0), detected_cards_n (0),
+      card_clauses_n (0), pb_counted_n (0),
+      clause_bytes (0), fixed_bytes (0), peak_bytes (0),
+      lit_values (0), var_levels (0), var_reasons (0), var_used (0),
+      var_sorted (0), level_stamps (0), var_stamps (0), sorted_varlist (0),
+      watched (0), occurs (0), occurs_n (0), incremental (false),
+      initialized (false), inconsistent (false)
 {
   add_param ("restarts", "specify restart strategy (minisat,rsat,picosat)",
       restart_strategy_string);
   add_param ("learn_fac", "specify learn clause number factor", learn_factor);
   add_param ("learn_start", "specify learn max clauses max number", learn_start);
+  add_param ("prefetch", "specify clause prefetch distance in BCP (0 - disable)",
+      prefetch_dist);
+  add_param ("shrink", "shrink learned clauses (all-UIP and binary implications)",
+      do_shrink);
+  add_param ("otfs", "on-the-fly strengthening of reasons in conflict analysis",
+      do_otfs);
+  add_param ("gauss", "Gauss-Jordan elimination of XOR constraints", do_gauss);
+  add_param ("xor_detect",
+      "max size of clauses encoding detected XORs (0 - disable)", xor_detect);
+  add_param ("card_detect",
+      "min size of detected at most one constraints (0 - disable)",
+      card_detect);
 }
 
 CDCLModule::~CDCLModule ()
 {
-  delete []varlist;
+  for (guint32 i = 0; i < temp_reasons.size (); i++)
+    free_clause (temp_reasons[i].second);
+  free_pb_reasons ();
+  delete []lit_values;
+  delete []var_levels;
+  delete []var_reasons;
+  delete []var_used;
+  delete []var_sorted;
+  delete []level_stamps;
+  delete []var_stamps;
+  delete []sorted_varlist;
   delete []watched;
+  delete []occurs;
+  delete []occurs_n;
 }
 
 MySatModule*
@@ -49,6 +83,12 @@ CDCLModule::post_process_params ()
     restart_strategy = RESTARTS_PICOSAT;
   else
     throw ModuleError (ModuleError::BAD_VALUE, "Unknown restart strategy");
+  if (xor_detect != 0 && (xor_detect < 3 || xor_detect > 10))
+    throw ModuleError (ModuleError::BAD_VALUE,
+          "XOR detection size must be 0 or in range 3-10");
+  if (card_detect == 1 || card_detect == 2)
+    throw ModuleError (ModuleError::BAD_VALUE,
+          "Cardinality detection size must be 0 or at least 3");
 }
 
 void
@@ -63,12 +103,545 @@ CDCLModule::fetch_problem (const CNF& cnf)
   for (guint i = 0; i < clauses_n; i++)
   {
     gint32 cl_size = form[idx];
-    ClausePtr ptr = create_clause (cl_size, form.begin () + idx + 1);
+    ClausePtr ptr = create_clause_n (cl_size);
+    ClauseRef ref = cref (ptr);
+    /* convert DIMACS literals to internal encoding */
+    for (gint32 j = 0; j < cl_size; j++)
+      ref[j] = dimacs2lit (form[idx + 1 + j]);
     orig_clauses[i] = ptr;
     idx += cl_size + 1;
     orig_literals_n += cl_size;
   }
   vars_n = cnf.get_vars_n ();
+
+  orig_xors.clear ();
+  const LiteralVector& xors = cnf.get_xors ();
+  idx = 0;
+  for (guint32 i = 0; i < cnf.get_xors_n (); i++)
+  {
+    add_xor (xors[idx], &xors[idx + 1]);
+    idx += xors[idx] + 1;
+  }
+  detected_xors_n = 0;
+  xor_clauses_n = 0;
+  if (xor_detect != 0)
+    detect_xors ();
+
+  orig_pbs.clear ();
+  const LiteralVector& cards = cnf.get_cards ();
+  idx = 0;
+  for (guint32 i = 0; i < cnf.get_cards_n (); i++)
+  {
+    add_card (cards[idx], &cards[idx + 2], cards[idx + 1]);
+    idx += cards[idx] + 2;
+  }
+  const PBVector& pbs = cnf.get_pbs ();
+  idx = 0;
+  for (guint32 i = 0; i < cnf.get_pbs_n (); i++)
+  {
+    add_cnf_pb (&pbs[idx]);
+    idx += 2*pbs[idx] + 2;
+  }
+  detected_cards_n = 0;
+  card_clauses_n = 0;
+  if (card_detect != 0)
+    detect_cards ();
+}
+
+void
+CDCLModule::add_xor (guint32 lits_n, const gint32* literals)
+{
+  xor_vars.clear ();
+  guint32 rhs = 1;
+  for (guint32 i = 0; i < lits_n; i++)
+  {
+    guint32 lit = dimacs2lit (literals[i]);
+    rhs ^= lit & 1; /* negation changes right hand side */
+    LitVector::iterator it = std::find (xor_vars.begin (), xor_vars.end (),
+          lit2var (lit));
+    if (it != xor_vars.end ())
+      xor_vars.erase (it); /* x^x = 0 */
+    else
+      xor_vars.push_back (lit2var (lit));
+  }
+
+  if (xor_vars.size () <= 1)
+  {
+    /* unit clause or empty clause (two contradictory units) */
+    guint32 lit = (xor_vars.empty ()) ? 0 : ((xor_vars[0]<<1) | (rhs ^ 1));
+    if (xor_vars.empty () && rhs == 0)
+      return;
+    for (guint32 k = 0; k < ((xor_vars.empty ()) ? 2U : 1U); k++)
+    {
+      ClausePtr ptr = create_clause_n (1);
+      cref (ptr)[0] = lit ^ k;
+      orig_clauses.push_back (ptr);
+      orig_literals_n++;
+    }
+    return;
+  }
+  orig_xors.push_back (xor_vars.size ());
+  orig_xors.push_back (rhs);
+  orig_xors.insert (orig_xors.end (), xor_vars.begin (), xor_vars.end ());
+}
+
+/* comparing clauses by sorted variables */
+struct CDCLXorKeyLess
+{
+  const std::vector<guint32>& keys;
+  guint32 stride;
+
+  CDCLXorKeyLess (const std::vector<guint32>& inkeys, guint32 instride)
+      : keys (inkeys), stride (instride)
+  { }
+
+  bool operator() (guint32 k1, guint32 k2) const
+  {
+    return std::lexicographical_compare (keys.begin () + k1*stride,
+          keys.begin () + (k1+1)*stride, keys.begin () + k2*stride,
+          keys.begin () + (k2+1)*stride);
+  }
+};
+
+/*
+ * XOR of k variables is encoded by 2^(k-1) clauses with same variables,
+ * which forbid assignments with wrong parity. clause with even number of
+ * negations forbids assignment with even number of true variables.
+ */
+void
+CDCLModule::detect_xors ()
+{
+  /* keys: size and sorted variables, padded */
+  const guint32 stride = xor_detect + 1;
+  std::vector<guint32> keys;
+  std::vector<guint32> cands; /* indices of clauses */
+  for (guint32 i = 0; i < orig_clauses.size (); i++)
+  {
+    ClauseRef clause = cref (orig_clauses[i]);
+    guint32 cl_size = clause.size ();
+    if (cl_size < 3 || cl_size > xor_detect)
+      continue;
+    guint32 start = keys.size ();
+    keys.resize (start + stride, G_MAXUINT32);
+    keys[start] = cl_size;
+    for (guint32 j = 0; j < cl_size; j++)
+      keys[start + 1 + j] = lit2var (clause[j]);
+    std::vector<guint32>::iterator kbegin = keys.begin () + start + 1;
+    std::sort (kbegin, kbegin + cl_size);
+    if (std::adjacent_find (kbegin, kbegin + cl_size) != kbegin + cl_size)
+    { /* repeated variable */
+      keys.resize (start);
+      continue;
+    }
+    cands.push_back (i);
+  }
+  if (cands.empty ())
+    return;
+
+  std::vector<guint32> order (cands.size ());
+  for (guint32 i = 0; i < order.size (); i++)
+    order[i] = i;
+  std::sort (order.begin (), order.end (), CDCLXorKeyLess (keys, stride));
+
+  /* detected row of clause (index in orig_xors from first detected) */
+  const guint32 first_row = xor_rows_n ();
+  std::vector<guint32> clause_rows (orig_clauses.size (), XorMatrix::NONE);
+  std::vector<guint32> masks;
+  std::vector<bool> seen;
+  for (guint32 gstart = 0; gstart < order.size (); )
+  {
+    const guint32* key = &keys[order[gstart]*stride];
+    guint32 gend = gstart + 1;
+    while (gend < order.size () &&
+          std::equal (key, key + stride, keys.begin () + order[gend]*stride))
+      gend++;
+    guint32 k = key[0];
+    if (gend - gstart < (1U << (k-1)))
+    {
+      gstart = gend;
+      continue;
+    }
+
+    /* sign mask of clause: bit j is set if variable j is negated */
+    masks.resize (gend - gstart);
+    for (guint32 g = gstart; g < gend; g++)
+    {
+      ClauseRef clause = cref (orig_clauses[cands[order[g]]]);
+      guint32 mask = 0;
+      for (guint32 j = 0; j < k; j++)
+        if ((clause[j] & 1) != 0)
+          mask |= 1U << (std::find (key + 1, key + 1 + k,
+                lit2var (clause[j])) - (key + 1));
+      masks[g - gstart] = mask;
+    }
+    for (guint32 parity = 0; parity < 2; parity++)
+    {
+      seen.assign (1U << k, false);
+      guint32 distinct = 0;
+      for (guint32 g = 0; g < masks.size (); g++)
+        if ((guint32 (__builtin_popcount (masks[g])) & 1) == parity &&
+            !seen[masks[g]])
+        {
+          seen[masks[g]] = true;
+          distinct++;
+        }
+      if (distinct != (1U << (k-1)))
+        continue;
+
+      for (guint32 g = gstart; g < gend; g++)
+        if ((guint32 (__builtin_popcount (masks[g - gstart])) & 1) == parity)
+          clause_rows[cands[order[g]]] = first_row + detected_xors_n;
+      orig_xors.push_back (k);
+      orig_xors.push_back (parity ^ 1);
+      orig_xors.insert (orig_xors.end (), key + 1, key + 1 + k);
+      detected_xors_n++;
+    }
+    gstart = gend;
+  }
+
+  if (detected_xors_n == 0)
+    return;
+
+  /* occurrences of variables in other clauses */
+  std::vector<guint32> var_occs (vars_n, 0);
+  for (guint32 i = 0; i < orig_clauses.size (); i++)
+    if (clause_rows[i] == XorMatrix::NONE)
+    {
+      ClauseRef clause = cref (orig_clauses[i]);
+      for (guint32 j = 0; j < clause.size (); j++)
+        var_occs[lit2var (clause[j])]++;
+    }
+  std::vector<guint32> row_comps;
+  guint32 comps_n = xor_components (row_comps);
+  std::vector<guint64> comp_occs (comps_n, 0);
+  std::vector<guint64> comp_lits (comps_n, 0);
+  std::vector<bool> var_counted (vars_n, false);
+  guint32 row = 0;
+  for (guint32 i = 0; i < orig_xors.size (); i += orig_xors[i] + 2, row++)
+  {
+    comp_lits[row_comps[row]] += orig_xors[i];
+    for (guint32 j = 0; j < orig_xors[i]; j++)
+      if (!var_counted[orig_xors[i + 2 + j]])
+      {
+        var_counted[orig_xors[i + 2 + j]] = true;
+        comp_occs[row_comps[row]] += var_occs[orig_xors[i + 2 + j]];
+      }
+  }
+
+  /* keep clauses of XORs which would not be eliminated */
+  LitVector new_xors;
+  std::vector<bool> keep_row (row, true);
+  row = 0;
+  for (guint32 i = 0; i < orig_xors.size (); i += orig_xors[i] + 2, row++)
+  {
+    guint32 c = row_comps[row];
+    if (row >= first_row &&
+        !(do_gauss && xors_dominate (comp_occs[c], comp_lits[c])))
+    {
+      keep_row[row] = false;
+      detected_xors_n--;
+    }
+    else
+      new_xors.insert (new_xors.end (), orig_xors.begin () + i,
+            orig_xors.begin () + i + orig_xors[i] + 2);
+  }
+  orig_xors.swap (new_xors);
+
+  guint32 ii = 0;
+  for (guint32 i = 0; i < orig_clauses.size (); i++)
+    if (clause_rows[i] != XorMatrix::NONE && keep_row[clause_rows[i]])
+    {
+      orig_literals_n -= cref (orig_clauses[i]).size ();
+      free_clause (orig_clauses[i]);
+      xor_clauses_n++;
+    }
+    else
+      orig_clauses[ii++] = orig_clauses[i];
+  orig_clauses.resize (ii);
+}
+
+guint32
+CDCLModule::xor_rows_n () const
+{
+  guint32 rows_n = 0;
+  for (guint32 i = 0; i < orig_xors.size (); i += orig_xors[i] + 2)
+    rows_n++;
+  return rows_n;
+}
+
+guint32
+CDCLModule::xor_components (std::vector<guint32>& row_comps) const
+{
+  /* union-find on variables */
+  std::vector<guint32> parent (vars_n);
+  for (guint32 v = 0; v < vars_n; v++)
+    parent[v] = v;
+  for (guint32 i = 0; i < orig_xors.size (); i += orig_xors[i] + 2)
+    for (guint32 j = 1; j < orig_xors[i]; j++)
+    {
+      guint32 r1 = orig_xors[i + 2], r2 = orig_xors[i + 2 + j];
+      while (parent[r1] != r1)
+        r1 = parent[r1] = parent[parent[r1]];
+      while (parent[r2] != r2)
+        r2 = parent[r2] = parent[parent[r2]];
+      parent[r2] = r1;
+    }
+
+  std::vector<guint32> root_comp (vars_n, XorMatrix::NONE);
+  guint32 comps_n = 0;
+  row_comps.clear ();
+  for (guint32 i = 0; i < orig_xors.size (); i += orig_xors[i] + 2)
+  {
+    guint32 root = orig_xors[i + 2];
+    while (parent[root] != root)
+      root = parent[root];
+    if (root_comp[root] == XorMatrix::NONE)
+      root_comp[root] = comps_n++;
+    row_comps.push_back (root_comp[root]);
+  }
+  return comps_n;
+}
+
+void
+CDCLModule::add_card (guint32 lits_n, const gint32* literals, guint32 bound)
+{
+  LitVector lits (lits_n);
+  for (guint32 i = 0; i < lits_n; i++)
+    lits[i] = dimacs2lit (literals[i]);
+  std::vector<gint64> weights (lits_n, 1);
+  add_pb (lits, weights, bound);
+}
+
+void
+CDCLModule::add_cnf_pb (const gint64* pb)
+{
+  /* sum c*l >= b is equivalent to sum -c*l <= -b */
+  guint32 lits_n = pb[0];
+  LitVector lits (lits_n);
+  std::vector<gint64> weights (lits_n);
+  for (guint32 i = 0; i < lits_n; i++)
+  {
+    weights[i] = -pb[2 + 2*i];
+    lits[i] = dimacs2lit (pb[3 + 2*i]);
+  }
+  add_pb (lits, weights, -pb[1]);
+}
+
+void
+CDCLModule::add_pb (LitVector& lits, std::vector<gint64>& weights, gint64 bound)
+{
+  /* merge terms of same variable to positive literals */
+  std::vector<std::pair<guint32, gint64> > terms;
+  for (guint32 i = 0; i < lits.size (); i++)
+    if ((lits[i] & 1) == 0)
+      terms.push_back (std::make_pair (lit2var (lits[i]), weights[i]));
+    else
+    {
+      /* w*-x = w - w*x */
+      terms.push_back (std::make_pair (lit2var (lits[i]), -weights[i]));
+      bound -= weights[i];
+    }
+  std::sort (terms.begin (), terms.end ());
+  lits.clear ();
+  weights.clear ();
+  for (guint32 i = 0; i < terms.size ();)
+  {
+    guint32 var = terms[i].first;
+    gint64 weight = 0;
+    for (; i < terms.size () && terms[i].first == var; i++)
+      weight += terms[i].second;
+    if (weight > 0)
+    {
+      lits.push_back (var<<1);
+      weights.push_back (weight);
+    }
+    else if (weight < 0)
+    {
+      /* w*x = w + (-w)*-x */
+      lits.push_back ((var<<1) | 1);
+      weights.push_back (-weight);
+      bound -= weight;
+    }
+  }
+
+  if (bound < 0)
+  {
+    /* unsatisfiable constraint: contradictory unit clauses */
+    if (vars_n == 0)
+      vars_n++;
+    for (guint32 i = 0; i < 2; i++)
+    {
+      ClausePtr ptr = create_clause_n (1);
+      cref (ptr)[0] = i;
+      orig_clauses.push_back (ptr);
+      orig_literals_n++;
+    }
+    return;
+  }
+  /* literals heavier than bound are false */
+  gint64 sum = 0;
+  guint32 j = 0;
+  for (guint32 i = 0; i < lits.size (); i++)
+    if (weights[i] > bound)
+    {
+      ClausePtr ptr = create_clause_n (1);
+      cref (ptr)[0] = neg (lits[i]);
+      orig_clauses.push_back (ptr);
+      orig_literals_n++;
+    }
+    else
+    {
+      lits[j] = lits[i];
+      weights[j++] = weights[i];
+      sum += weights[i];
+    }
+  lits.resize (j);
+  weights.resize (j);
+  if (sum <= bound)
+    return;
+
+  if (std::count (weights.begin (), weights.end (), weights[0]) ==
+      gint64 (weights.size ()))
+  {
+    /* cardinality constraint */
+    bound /= weights[0];
+    weights.assign (weights.size (), 1);
+    if (bound + 1 == gint64 (lits.size ()))
+    {
+      /* at least one literal is false */
+      ClausePtr ptr = create_clause_n (lits.size ());
+      ClauseRef clause = cref (ptr);
+      for (guint32 i = 0; i < lits.size (); i++)
+        clause[i] = neg (lits[i]);
+      orig_clauses.push_back (ptr);
+      orig_literals_n += lits.size ();
+      return;
+    }
+  }
+
+  terms.clear ();
+  for (guint32 i = 0; i < lits.size (); i++)
+    terms.push_back (std::make_pair (lits[i], weights[i]));
+  std::sort (terms.begin (), terms.end (), ByWeight ());
+  orig_pbs.push_back (bound);
+  orig_pbs.push_back (terms[0].second);
+  orig_pbs.push_back (terms.size ());
+  for (guint32 i = 0; i < terms.size (); i++)
+  {
+    orig_pbs.push_back (terms[i].second);
+    orig_pbs.push_back (terms[i].first);
+  }
+}
+
+/*
+ * binary clause (-a or -b) forbids that both a and b are true, so
+ * clique of such clauses is at most one constraint. cliques are found
+ * greedily from literals with many binary clauses, every clause
+ * is replaced at most once.
+ */
+void
+CDCLModule::detect_cards ()
+{
+  /* neighbours of literals with indices of clauses */
+  std::vector<std::vector<std::pair<guint32, guint32> > > edges (vars_n<<1);
+  guint64 binaries_n = 0;
+  for (guint32 i = 0; i < orig_clauses.size (); i++)
+  {
+    ClauseRef clause = cref (orig_clauses[i]);
+    if (clause.size () != 2 || lit2var (clause[0]) == lit2var (clause[1]))
+      continue;
+    edges[neg (clause[0])].push_back (std::make_pair (neg (clause[1]), i));
+    edges[neg (clause[1])].push_back (std::make_pair (neg (clause[0]), i));
+    binaries_n++;
+  }
+  if (binaries_n == 0)
+    return;
+
+  std::vector<std::pair<guint32, guint32> > order;
+  for (guint32 l = 0; l < (vars_n<<1); l++)
+    if (edges[l].size () + 1 >= card_detect)
+      order.push_back (std::make_pair (edges[l].size (), l));
+  std::sort (order.rbegin (), order.rend ());
+
+  std::vector<bool> removed (orig_clauses.size (), false);
+  std::vector<guint32> stamps (vars_n<<1, 0);
+  std::vector<bool> in_clique (vars_n<<1, false);
+  guint32 stamp = 0;
+  /* work limit: visited neighbours */
+  guint64 steps = 0;
+  const guint64 max_steps = 16 * binaries_n + 1000000;
+  LitVector clique;
+  std::vector<std::pair<guint32, guint32> > cands;
+  std::vector<gint32> literals;
+  for (guint32 o = 0; o < order.size () && steps < max_steps; o++)
+  {
+    guint32 lit = order[o].second;
+    cands.clear ();
+    for (guint32 k = 0; k < edges[lit].size (); k++)
+      if (!removed[edges[lit][k].second])
+        cands.push_back (std::make_pair (edges[edges[lit][k].first].size (),
+              edges[lit][k].first));
+    if (cands.size () + 1 < card_detect)
+      continue;
+    std::sort (cands.rbegin (), cands.rend ());
+
+    clique.assign (1, lit);
+    for (guint32 k = 0; k < cands.size () && steps < max_steps; k++)
+    {
+      guint32 cand = cands[k].second;
+      if (k != 0 && cand == cands[k-1].second)
+        continue; /* repeated clause */
+      stamp++;
+      const std::vector<std::pair<guint32, guint32> >& cedges = edges[cand];
+      steps += cedges.size ();
+      for (guint32 e = 0; e < cedges.size (); e++)
+        if (!removed[cedges[e].second])
+          stamps[cedges[e].first] = stamp;
+      guint32 m = 1;
+      for (; m < clique.size () && stamps[clique[m]] == stamp; m++);
+      if (m == clique.size ())
+        clique.push_back (cand);
+    }
+    if (clique.size () < card_detect)
+      continue;
+
+    /* remove clauses of clique */
+    for (guint32 m = 0; m < clique.size (); m++)
+      in_clique[clique[m]] = true;
+    for (guint32 m = 0; m < clique.size (); m++)
+    {
+      const std::vector<std::pair<guint32, guint32> >& medges = edges[clique[m]];
+      steps += medges.size ();
+      for (guint32 e = 0; e < medges.size (); e++)
+        if (in_clique[medges[e].first] && !removed[medges[e].second])
+        {
+          removed[medges[e].second] = true;
+          card_clauses_n++;
+        }
+    }
+    literals.clear ();
+    for (guint32 m = 0; m < clique.size (); m++)
+    {
+      in_clique[clique[m]] = false;
+      literals.push_back ((clique[m] & 1) ? -gint32 (lit2var (clique[m])+1) :
+            gint32 (lit2var (clique[m])+1));
+    }
+    add_card (literals.size (), &literals[0], 1);
+    detected_cards_n++;
+  }
+
+  if (detected_cards_n == 0)
+    return;
+  guint32 ii = 0;
+  for (guint32 i = 0; i < orig_clauses.size (); i++)
+    if (removed[i])
+    {
+      orig_literals_n -= 2;
+      free_clause (orig_clauses[i]);
+    }
+    else
+      orig_clauses[ii++] = orig_clauses[i];
+  orig_clauses.resize (ii);
 }
 
 Result
@@ -89,15 +662,42 @@ CDCLModule::initialize ()
   //learned_n = 0;
   learned_lits_n = 0;
   removed_literals_n = 0;
+#ifdef MYSAT_COUNTERS
+  perf_counters.clear ();
+#endif
+  strengthened_n = 0;
   /* first initialize */
-  delete []varlist;
-  varlist = new Variable[vars_n];
+  /* 3 bytes of padding for dword loads in litval_scan */
+  delete []lit_values;
+  lit_values = new guchar[2*vars_n + 3];
+  std::fill (lit_values, lit_values + 2*vars_n + 3, FLAGS_UNASSIGN);
+  delete []var_levels;
+  var_levels = new guint32[vars_n];
+  std::fill (var_levels, var_levels + vars_n, 0);
+  free_pb_reasons ();
+  delete []var_reasons;
+  var_reasons = new ClausePtr[vars_n];
+  std::fill (var_reasons, var_reasons + vars_n, CLAUSE_NULL);
+  delete []var_used;
+  var_used = new guchar[vars_n];
+  std::fill (var_used, var_used + vars_n, 0);
+  delete []var_sorted;
+  var_sorted = new guint32[vars_n];
+  delete []level_stamps;
+  level_stamps = new guint32[vars_n + 1];
+  std::fill (level_stamps, level_stamps + vars_n + 1, 0);
+  level_stamp = 0;
+  delete []var_stamps;
+  var_stamps = new guint32[vars_n];
+  std::fill (var_stamps, var_stamps + vars_n, 0);
+  var_stamp = 0;
   delete []sorted_varlist;
   sorted_varlist = new ScoredVar[vars_n];
   //scored_learned.clear ();
 
   //orig_clauses.clear ();
   learned_clauses.clear ();
+  init_assumptions ();
 
   used_vars_n = vars_n;
 
@@ -115,6 +715,73 @@ CDCLModule::initialize ()
   for (guint32 i = 0; i < vars_n; i++)
     sorted_varlist[i].var = i;
 
+  delete []occurs;
+  occurs = new WatchedList[vars_n<<1];
+  delete []occurs_n;
+  occurs_n = new guint32[vars_n<<1];
+  std::fill (occurs_n, occurs_n + (vars_n<<1), 0);
+  occurs_dirty.assign (vars_n<<1, false);
+  dirty_occurs.clear ();
+  guint64 occurs_lits_n = 0;
+  for (guint i = 0; i < orig_clauses.size (); i++)
+  {
+    ClauseRef ref = cref (orig_clauses[i]);
+    for (guint32 j = 0; j < ref.size (); j++)
+    {
+      occurs[ref[j]].push_back (orig_clauses[i]);
+      occurs_n[ref[j]]++;
+    }
+    occurs_lits_n += ref.size ();
+  }
+  simplified_n = 0;
+  orig_garbage_n = 0;
+  /* all variables can be unused at begin */
+  pure_candidates.resize (vars_n);
+  for (guint32 i = 0; i < vars_n; i++)
+    pure_candidates[i] = i;
+
+  for (guint32 i = 0; i < temp_reasons.size (); i++)
+    free_clause (temp_reasons[i].second);
+  temp_reasons.clear ();
+  if (!init_xor_matrices ())
+    return UNSATISFIABLE;
+  for (guint32 i = 0; i < orig_xors.size (); i += orig_xors[i] + 2)
+    for (guint32 j = 0; j < orig_xors[i]; j++)
+    {
+      /* variables of XORs are never pure */
+      guint32 var = orig_xors[i + 2 + j];
+      occurs_n[var<<1]++;
+      occurs_n[(var<<1) | 1]++;
+      sorted_varlist[var].increment (var<<1, score_inc);
+    }
+  init_pbs ();
+  for (guint32 i = 0; i < assumptions.size (); i++)
+  {
+    /* assumed variables are never pure */
+    guint32 lit = assumptions[i];
+    occurs_n[lit]++;
+    occurs_n[neg (lit)]++;
+  }
+
+  fixed_bytes = guint64 (vars_n) * (2 + sizeof (guint32) + sizeof (ClausePtr) +
+        1 + 3 * sizeof (guint32) + sizeof (ScoredVar) + 2 * sizeof (WatchedList));
+  /* occurrence lists (only decrease) */
+  fixed_bytes += guint64 (vars_n) * 2 * (sizeof (WatchedList) + sizeof (guint32)) +
+        occurs_lits_n * sizeof (ClausePtr);
+  for (guint32 i = 0; i < xor_matrices.size (); i++)
+    fixed_bytes += xor_matrices[i].get_bytes ();
+  fixed_bytes += guint64 (var_xor_matrix.size () + var_xor_col.size ()) *
+        sizeof (guint32);
+  fixed_bytes += guint64 (orig_pbs.size () + pb_sums.size ()) *
+        sizeof (guint64) + guint64 (pb_starts.size () + var_count_pos.size () +
+        var_pb.size () + var_pb_pos.size ()) * sizeof (guint32);
+  if (!pb_occurs.empty ())
+    fixed_bytes += guint64 (vars_n) * 2 * sizeof (PBOccurList) +
+        guint64 (orig_pbs.size () - 3 * pb_starts.size ()) / 2 * sizeof (PBOccur);
+  peak_bytes = std::max (peak_bytes, used_bytes ());
+  next_memory_check = 0;
+  memory_reduces_n = 0;
+
   {
     //for (guint i = 0; i < cnf.get_clauses_n (); i++)
     for (guint i = 0; i < orig_clauses.size (); i++)
@@ -125,7 +792,7 @@ CDCLModule::initialize ()
 	add_to_twl (orig_clauses[i]);
       else if (ref.size () == 1) /* unit clause */
       {
-	gint32 lit = ref[0];
+	guint32 lit = ref[0];
 	guint32 value_lit = value (lit);
 	if (value_lit == 0)
 	{
@@ -138,7 +805,7 @@ CDCLModule::initialize ()
       /* initializing scoring (VMTF) */
       for (guint32 j = 0; j < ref.size (); j++)
       {
-	gint32 lit = ref[j];
+	guint32 lit = ref[j];
 	sorted_varlist[lit2var (lit)].increment (lit, score_inc);
       }
       //idx += clause_size + 2;
@@ -147,10 +814,10 @@ CDCLModule::initialize ()
   /* sort sorted_varlist */
   std::sort (sorted_varlist, sorted_varlist + vars_n);
   for (guint32 i = 0; i < vars_n; i++)
-    varlist[sorted_varlist[i].var].sorted = i;
+    var_sorted[sorted_varlist[i].var] = i;
 
   for (sorted_highest = vars_n; sorted_highest > 0; sorted_highest--)
-    if (!varlist[sorted_varlist[sorted_highest-1].var].assigned ())
+    if (!assigned (sorted_varlist[sorted_highest-1].var))
       break;
   sorted_highest--;
 
@@ -163,11 +830,11 @@ CDCLModule::initialize ()
  */
 
 Result
-CDCLModule::do_propagate (gint32 literal)
+CDCLModule::do_propagate (guint32 literal)
 {
   //LiteralVector& form = cnf.get_formulae ();
 
-  if (literal != 0)
+  if (literal != LIT_UNDEF)
   {
     impl_queue.push_back (Implicate (CLAUSE_NULL, literal));
     assign (CLAUSE_NULL, literal);
@@ -180,49 +847,67 @@ CDCLModule::do_propagate (gint32 literal)
   {
     Implicate impl_elem = impl_queue.front ();
     impl_queue.pop_front ();
+    propagations_n++;
 
-    WatchedList& wc = lit2w (-impl_elem.lit);
+    guint32 falselit = neg (impl_elem.lit);
+    WatchedList& wc = lit2w (falselit);
     //assert (istrue (impl_elem.lit));
 
     guint32 ii = 0;
+    guint32 wc_size = wc.size ();
+    /* watch list and one cache line per clause */
+    ticks_n += 1 + wc_size;
+    /* first clauses to prefetch */
+    for (guint32 i = 0; i < prefetch_dist && i < wc_size; i++)
+      __builtin_prefetch (wc[i], 1);
     for (guint32 i = 0; i < wc.size (); i++)
     {
+      /* clause header and watched literals are in first cache line */
+      if (i + prefetch_dist < wc_size)
+	__builtin_prefetch (wc[i + prefetch_dist], 1);
       //guint32 clidx = wc[i];
       ClausePtr clauseptr = wc[i];
       ClauseRef clause = cref (clauseptr);
+      MYSAT_COUNT (PC_WATCH_VISITS);
 
       guint32 cl_size = clause.size ();
       //clidx += 2;
 
-      if (-impl_elem.lit != clause[1])
+      if (falselit != clause[1])
         std::swap (clause[0], clause[1]);
 
       //assert (-impl_elem.lit == clause[1]);
       bool if_newwatch = false;
 
       if (istrue (clause[0]))
+      {
+	MYSAT_COUNT (PC_FIRST_WATCH_TRUE);
 	wc[ii++] = wc[i];
+      }
       else
       {
-	for (guint j = 2; j < cl_size; j++)
-	{
-	  gint32 lit = clause[j];
-	  if (istrue (-lit))
-	    continue; /* skip false's */
-	  else
-	  { /* if other literal is free or true then is new watch */
-	    lit2w (lit).push_back (clauseptr);
-	    std::swap (clause[1], clause[j]);
-	    if_newwatch = true;
-	    break;
-	  }
+	guint32 j;
+	if (cl_size > 2)
+	  MYSAT_COUNT_REPLACE (cl_size);
+	if (cl_size - 2 >= lit_scan_min_size)
+	  j = 2 + litval_scan (&clause[2], cl_size-2, lit_values);
+	else /* skip false's */
+	  for (j = 2; j < cl_size && istrue (neg (clause[j])); j++);
+	/* next cache lines of clause (16 literals per line) */
+	ticks_n += (j - 2) >> 4;
+
+	if (j < cl_size)
+	{ /* if other literal is free or true then is new watch */
+	  lit2w (clause[j]).push_back (clauseptr);
+	  std::swap (clause[1], clause[j]);
+	  if_newwatch = true;
 	}
 
 	if (!if_newwatch)
 	{
 	  wc[ii++] = wc[i];
-	  gint32 implit = clause[0];
-	  gint32 implit_val = value (implit);
+	  guint32 implit = clause[0];
+	  guint32 implit_val = value (implit);
 	  if (implit_val == FLAGS_FALSE)
 	  { /* if false */
 	    /*assert (assigns.get (-form[clidx]) ||
@@ -238,6 +923,7 @@ CDCLModule::do_propagate (gint32 literal)
 	  else if (implit_val == 0)
 	  { /* if free */
 	    //std::cout << "To queue: " << implit << ", clidx: " << clidx << std::endl;
+	    MYSAT_COUNT ((cl_size == 2) ? PC_BINARY_IMPLS : PC_LONG_IMPLS);
 	    assign (clauseptr, implit);
 	    impl_queue.push_back (Implicate (clauseptr, implit));
 	  }
@@ -246,8 +932,263 @@ CDCLModule::do_propagate (gint32 literal)
       }
     }
     wc.resize (ii);
+
+    if (!var_xor_matrix.empty () &&
+        xor_propagate (lit2var (impl_elem.lit)) == UNSATISFIABLE)
+    {
+      impl_queue.clear ();
+      return UNSATISFIABLE;
+    }
+    if (!pb_occurs.empty () &&
+        pb_propagate (impl_elem.lit) == UNSATISFIABLE)
+    {
+      impl_queue.clear ();
+      return UNSATISFIABLE;
+    }
+  }
+
+  return SATISFIABLE;
+}
+
+bool
+CDCLModule::init_xor_matrices ()
+{
+  xor_matrices.clear ();
+  var_xor_matrix.clear ();
+  var_xor_col.clear ();
+  if (orig_xors.empty ())
+    return true;
+
+  /* rows with columns local to matrix of component */
+  std::vector<guint32> row_comps;
+  guint32 comps_n = xor_components (row_comps);
+  var_xor_matrix.assign (vars_n, XorMatrix::NONE);
+  var_xor_col.assign (vars_n, XorMatrix::NONE);
+  std::vector<std::vector<guint32> > cols (comps_n);
+  std::vector<std::vector<guint32> > rows (comps_n);
+  std::vector<guint64> xor_lits (comps_n, 0);
+  guint32 row = 0;
+  for (guint32 i = 0; i < orig_xors.size (); i += orig_xors[i] + 2, row++)
+  {
+    guint32 m = row_comps[row];
+    xor_lits[m] += orig_xors[i];
+    rows[m].push_back (orig_xors[i]);
+    rows[m].push_back (orig_xors[i + 1]);
+    for (guint32 j = 0; j < orig_xors[i]; j++)
+    {
+      guint32 var = orig_xors[i + 2 + j];
+      if (var_xor_matrix[var] == XorMatrix::NONE)
+      {
+        var_xor_matrix[var] = m;
+        var_xor_col[var] = cols[m].size ();
+        cols[m].push_back (var);
+      }
+      rows[m].push_back (var_xor_col[var]);
+    }
+  }
+
+  xor_matrices.resize (cols.size ());
+  for (guint32 m = 0; m < xor_matrices.size (); m++)
+  {
+    guint64 clause_occs = 0;
+    for (guint32 c = 0; c < cols[m].size (); c++)
+      clause_occs += occurs_n[cols[m][c]<<1] + occurs_n[(cols[m][c]<<1) | 1];
+    bool use_gauss = do_gauss && xors_dominate (clause_occs, xor_lits[m]);
+    xor_impls.clear ();
+    /* gauss elimination only for matrices up to 1 MB */
+    if (!xor_matrices[m].init (cols[m], rows[m], use_gauss, 1U<<17,
+          lit_values, var_levels, xor_impls))
+      return false;
+    if (!assign_xor_impls (xor_matrices[m]))
+      return false;
+  }
+  return true;
+}
+
+CDCLModule::ClausePtr
+CDCLModule::xor_clause (const XorMatrix& matrix, guint32 row, guint32 implied)
+{
+  matrix.row_vars (row, xor_vars);
+  ClausePtr clauseptr = create_clause_n (xor_vars.size ());
+  ClauseRef clause = cref (clauseptr);
+  clause.set_temporary ();
+  guint32 j = (implied != LIT_UNDEF) ? 1 : 0;
+  for (guint32 i = 0; i < xor_vars.size (); i++)
+  {
+    guint32 var = xor_vars[i];
+    if (implied != LIT_UNDEF && var == lit2var (implied))
+      clause[0] = implied;
+    else /* false literal */
+      clause[j++] = (var<<1) | ((istrue (var<<1)) ? 1 : 0);
+  }
+  temp_reasons.push_back (std::make_pair (guint32 (assign_stack.size ()),
+        clauseptr));
+  return clauseptr;
+}
+
+bool
+CDCLModule::assign_xor_impls (const XorMatrix& matrix)
+{
+  for (guint32 i = 0; i < xor_impls.size (); i++)
+  {
+    guint32 lit = (xor_impls[i].var<<1) | ((xor_impls[i].value) ? 0 : 1);
+    guint32 lit_val = value (lit);
+    if (lit_val == FLAGS_FALSE)
+    {
+      current_conflict = xor_clause (matrix, xor_impls[i].row, LIT_UNDEF);
+      return false;
+    }
+    else if (lit_val == 0)
+    {
+      ClausePtr reason = xor_clause (matrix, xor_impls[i].row, lit);
+      assign (reason, lit);
+      impl_queue.push_back (Implicate (reason, lit));
+    }
+  }
+  return true;
+}
+
+Result
+CDCLModule::xor_propagate (guint32 var)
+{
+  guint32 m = var_xor_matrix[var];
+  if (m == XorMatrix::NONE)
+    return SATISFIABLE;
+  XorMatrix& matrix = xor_matrices[m];
+  xor_impls.clear ();
+  guint32 conflict_row = matrix.assign (var_xor_col[var], xor_impls);
+  ticks_n += 1 + xor_impls.size ();
+  if (conflict_row != XorMatrix::NONE)
+  {
+    current_conflict = xor_clause (matrix, conflict_row, LIT_UNDEF);
+    return UNSATISFIABLE;
+  }
+  return (assign_xor_impls (matrix)) ? SATISFIABLE : UNSATISFIABLE;
+}
+
+void
+CDCLModule::init_pbs ()
+{
+  pb_starts.clear ();
+  pb_occurs.clear ();
+  var_count_pos.clear ();
+  var_pb.clear ();
+  var_pb_pos.clear ();
+  pb_counted_n = 0;
+  if (orig_pbs.empty ())
+    return;
+
+  pb_occurs.resize (vars_n<<1);
+  for (guint32 i = 0; i < orig_pbs.size (); i += 2*orig_pbs[i + 2] + 3)
+  {
+    guint32 pb = pb_starts.size ();
+    pb_starts.push_back (i);
+    for (guint32 j = 0; j < orig_pbs[i + 2]; j++)
+    {
+      guint32 lit = orig_pbs[i + 4 + 2*j];
+      pb_occurs[lit].push_back (PBOccur (pb, orig_pbs[i + 3 + 2*j]));
+      /* constraint is satisfied by false literal */
+      occurs_n[neg (lit)]++;
+      sorted_varlist[lit2var (lit)].increment (lit, score_inc);
+    }
   }
+  pb_sums.assign (pb_starts.size (), 0);
+  var_count_pos.assign (vars_n, NO_PB);
+  var_pb.assign (vars_n, NO_PB);
+  var_pb_pos.assign (vars_n, 0);
+}
 
+void
+CDCLModule::free_pb_reasons ()
+{
+  for (guint32 v = 0; v < var_pb.size (); v++)
+    if (var_pb[v] != NO_PB && var_reasons[v] != CLAUSE_PB)
+      free_clause (var_reasons[v]);
+  var_pb.clear ();
+}
+
+CDCLModule::ClausePtr
+CDCLModule::pb_clause (guint32 pb, guint32 first, guint32 counted_n)
+{
+  const guint64* terms = &orig_pbs[pb_starts[pb]];
+  guint32 terms_n = terms[2];
+  terms += 3;
+  guint32 true_n = 0;
+  for (guint32 i = 0; i < terms_n; i++)
+  {
+    guint32 lit = terms[2*i + 1];
+    if (var_count_pos[lit2var (lit)] < counted_n && istrue (lit))
+      true_n++;
+  }
+
+  guint32 j = (first != LIT_UNDEF) ? 1 : 0;
+  ClausePtr clauseptr = create_clause_n (true_n + j);
+  ClauseRef clause = cref (clauseptr);
+  clause.set_temporary ();
+  if (first != LIT_UNDEF)
+    clause[0] = first;
+  for (guint32 i = 0; i < terms_n; i++)
+  {
+    guint32 lit = terms[2*i + 1];
+    if (var_count_pos[lit2var (lit)] < counted_n && istrue (lit))
+      clause[j++] = neg (lit);
+  }
+  return clauseptr;
+}
+
+Result
+CDCLModule::pb_propagate (guint32 lit)
+{
+  assert (assign_stack[pb_counted_n] == lit);
+  var_count_pos[lit2var (lit)] = pb_counted_n++;
+  const PBOccurList& pbs = pb_occurs[lit];
+  for (guint32 i = 0; i < pbs.size (); i++)
+    pb_sums[pbs[i].pb] += pbs[i].weight;
+  ticks_n += pbs.size ();
+
+  for (guint32 i = 0; i < pbs.size (); i++)
+  {
+    guint32 pb = pbs[i].pb;
+    const guint64* terms = &orig_pbs[pb_starts[pb]];
+    guint64 bound = terms[0];
+    guint64 sum = pb_sums[pb];
+    if (sum + terms[1] <= bound)
+      continue;
+    if (sum > bound)
+    {
+      current_conflict = pb_clause (pb, LIT_UNDEF, pb_counted_n);
+      temp_reasons.push_back (std::make_pair (guint32 (assign_stack.size ()),
+            current_conflict));
+      return UNSATISFIABLE;
+    }
+
+    /* literals heavier than slack must be false */
+    guint64 slack = bound - sum;
+    guint32 terms_n = terms[2];
+    terms += 3;
+    guint32 j = 0;
+    for (; j < terms_n && terms[2*j] > slack; j++)
+    {
+      guint32 tlit = terms[2*j + 1];
+      if (value (tlit) == 0)
+      {
+        guint32 implit = neg (tlit);
+        assign (CLAUSE_PB, implit);
+        var_pb[lit2var (implit)] = pb;
+        var_pb_pos[lit2var (implit)] = pb_counted_n;
+        impl_queue.push_back (Implicate (CLAUSE_PB, implit));
+      }
+      else if (istrue (tlit) && var_count_pos[lit2var (tlit)] == NO_PB)
+      {
+        /* true literal (later in BCP) exceeds bound */
+        current_conflict = pb_clause (pb, neg (tlit), pb_counted_n);
+        temp_reasons.push_back (std::make_pair (guint32 (assign_stack.size ()),
+              current_conflict));
+        return UNSATISFIABLE;
+      }
+    }
+    ticks_n += j >> 4;
+  }
   return SATISFIABLE;
 }
 
@@ -263,13 +1204,43 @@ CDCLModule::undo_propagate (guint32 level)
   guint32 end = assign_indices[level+1];
   for (guint32 i = end; i < assign_stack.size (); i++)
   {
-    Variable& v = getvar (assign_stack[i].lit);
-    v.unassign ();
-    sorted_highest = std::max (v.sorted, sorted_highest);
+    guint32 lit = assign_stack[i];
+    unsetlit (lit);
+    sorted_highest = std::max (var_sorted[lit2var (lit)], sorted_highest);
+  }
+  if (!pb_occurs.empty ())
+  {
+    for (guint32 i = end; i < pb_counted_n; i++)
+    {
+      guint32 lit = assign_stack[i];
+      var_count_pos[lit2var (lit)] = NO_PB;
+      const PBOccurList& pbs = pb_occurs[lit];
+      for (guint32 k = 0; k < pbs.size (); k++)
+        pb_sums[pbs[k].pb] -= pbs[k].weight;
+    }
+    pb_counted_n = std::min (pb_counted_n, end);
+    /* free created reasons of undone implications */
+    for (guint32 i = end; i < assign_stack.size (); i++)
+    {
+      guint32 var = lit2var (assign_stack[i]);
+      if (var_pb[var] == NO_PB)
+        continue;
+      if (var_reasons[var] != CLAUSE_PB)
+        free_clause (var_reasons[var]);
+      var_pb[var] = NO_PB;
+    }
   }
   assign_indices.resize (level+1);
   assign_stack.resize (end);
   decision_level = level;
+  next_assumption = 0;
+
+  /* free temporary reasons and conflicts of undone assignments */
+  while (!temp_reasons.empty () && temp_reasons.back ().first >= end)
+  {
+    delete_clause (temp_reasons.back ().second);
+    temp_reasons.pop_back ();
+  }
 }
 
 /*
@@ -277,18 +1248,18 @@ CDCLModule::undo_propagate (guint32 level)
  */
 
 guint32
-CDCLModule::derivate_impls (gint32& uip)
+CDCLModule::derivate_impls (guint32& uip)
 {
-  LiteralVector aclause; /* asserting clause */
+  LitVector aclause; /* asserting clause */
   ClausePtr clauseptr = current_conflict;
   std::vector<guint32> used_indices;
 
   /* check for assigned in 0 level */
   /*for (guint32 i = 0; i < vars_n; i++)
-    if (varlist[i].assigned () && varlist[i].level == 0)
-      assert (varlist[i].is_used ());
+    if (assigned (i) && var_levels[i] == 0)
+      assert (is_used (i));
     else
-      assert (!varlist[i].is_used ());*/
+      assert (!is_used (i));*/
 
   guint32 impls_n = 0;
   guint32 pos = assign_stack.size ()-1; /* stack pos */
@@ -303,20 +1274,24 @@ CDCLModule::derivate_impls (gint32& uip)
     if (clauseptr != CLAUSE_NULL)
     {
       ClauseRef clause = cref (clauseptr);
+      MYSAT_COUNT (PC_CLAUSE_DEREFS);
 
-      gint32 cl_size = clause.size ();
+      guint32 cl_size = clause.size ();
 
       if (clause.learned ())
         increment_clause_score (clauseptr);
 
-      for (gint32 j = 0; j < cl_size; j++)
+      guint32 level0_n = 0;
+      for (guint32 j = 0; j < cl_size; j++)
       {
 	guint32 vidx = lit2var (clause[j]);
-	if (!varlist[vidx].is_used ())
+	if (var_levels[vidx] == 0)
+	  level0_n++;
+	else if (!is_used (vidx))
 	{
-	  assert (varlist[vidx].level != 0);
+	  assert (var_levels[vidx] != 0);
 	  {
-	    guint32 idx = varlist[vidx].sorted;
+	    guint32 idx = var_sorted[vidx];
 	    sorted_varlist[idx].increment (clause[j], score_inc);
 	    if (sorted_varlist[idx].value () > score_limit)
 	      to_rescale = true;
@@ -324,37 +1299,42 @@ CDCLModule::derivate_impls (gint32& uip)
 	    for (; idx + 1 < vars_n && sorted_varlist[idx+1] < sorted_varlist[idx]; idx++)
 	    {
 	      std::swap (sorted_varlist[idx], sorted_varlist[idx+1]);
-	      varlist[sorted_varlist[idx].var].sorted = idx;
+	      var_sorted[sorted_varlist[idx].var] = idx;
 	    }
-	    varlist[sorted_varlist[idx].var].sorted = idx;
+	    var_sorted[sorted_varlist[idx].var] = idx;
 	  }
 
-	  varlist[vidx].use ();
+	  use (vidx);
 	  used_indices.push_back (vidx);
-	  if (varlist[vidx].level < decision_level)
+	  if (var_levels[vidx] < decision_level)
 	  {
 	    aclause.push_back (clause[j]);
-	    shallowest_level = std::max (varlist[vidx].level, shallowest_level);
+	    shallowest_level = std::max (var_levels[vidx], shallowest_level);
 	  }
 	  else
 	    impls_n++;
 	}
       }
+      /* on-the-fly strengthening: if resolvent (without pivot) subsumes
+       * reason clause then pivot can be removed from this clause */
+      if (do_otfs && clauseptr != current_conflict && impls_n >= 2 &&
+          !clause.temporary () &&
+          aclause.size () + impls_n + level0_n == cl_size - 1)
+        strengthen_reason (clauseptr);
     }
 
-    gint32 lit = assign_stack[pos].lit;
-    Variable& v = getvar (lit);
+    guint32 lit = assign_stack[pos];
 
-    if (v.is_used ())
+    if (is_used (lit2var (lit)))
     { /* to resolve */
       if (impls_n > 1)
       {
-	clauseptr = assign_stack[pos].clause;
+	clauseptr = reason (lit2var (lit));
         impls_n--;
       }
       else
       {
-	aclause.push_back (-lit);
+	aclause.push_back (neg (lit));
 	impls_n = 0;
 	/*if (pos != assign_indices.back ())
 	{
@@ -374,58 +1354,6 @@ CDCLModule::derivate_impls (gint32& uip)
   }
 //#endif
 
-#if 0
-  gint32 impl = 0;
-  do {
-    ClauseRef clause = cref (clauseptr);
-
-    gint32 cl_size = clause.size ();
-
-    if (clause.learned ())
-      increment_clause_score (clauseptr);
-
-    for (gint32 j = (impl != 0) ? 1 : 0; j < cl_size; j++)
-    {
-      guint32 vidx = lit2var (clause[j]);
-      if (!varlist[vidx].is_used ())
-      {
-	assert (varlist[vidx].level != 0);
-	{
-	  guint32 idx = varlist[vidx].sorted;
-	  sorted_varlist[idx].increment (clause[j], score_inc);
-	  if (sorted_varlist[idx].value () > score_limit)
-	    to_rescale = true;
-
-	  for (; idx + 1 < vars_n && sorted_varlist[idx+1] < sorted_varlist[idx]; idx++)
-	  {
-	    std::swap (sorted_varlist[idx], sorted_varlist[idx+1]);
-	    varlist[sorted_varlist[idx].var].sorted = idx;
-	  }
-	  varlist[sorted_varlist[idx].var].sorted = idx;
-	}
-
-	varlist[vidx].use ();
-	used_indices.push_back (vidx);
-	if (varlist[vidx].level < decision_level)
-	{
-	  aclause.push_back (clause[j]);
-	  shallowest_level = std::max (varlist[vidx].level, shallowest_level);
-	}
-	else
-	  impls_n++;
-      }
-    }
-
-    while (!varlist[lit2var (assign_stack[pos--].lit)].is_used ());
-    impl = assign_stack[pos+1].lit;
-    clauseptr = assign_stack[pos+1].clause;
-    getvar (impl).unuse ();
-    impls_n--;
-
-  } while (impls_n > 0);
-
-  aclause.push_back (-impl);
-#endif
 
   if (impls_n != 0)
   {
@@ -436,15 +1364,31 @@ CDCLModule::derivate_impls (gint32& uip)
   if (aclause.size () >= 2)
     shallowest_level = minimize_clause (aclause, used_indices);
 
+  if (do_shrink && aclause.size () >= 3)
+  {
+    shrink_clause (aclause, used_indices);
+    /* recompute shallowest level and keep its literal to be watched */
+    shallowest_level = 0;
+    guint32 maxpos = 0;
+    for (guint32 i = 0; i < aclause.size ()-1; i++)
+      if (var_levels[lit2var (aclause[i])] > shallowest_level)
+      {
+        shallowest_level = var_levels[lit2var (aclause[i])];
+        maxpos = i;
+      }
+    if (aclause.size () >= 3)
+      std::swap (aclause[1], aclause[maxpos]);
+  }
+
   for (std::vector<guint32>::const_iterator it = used_indices.begin ();
 	it != used_indices.end (); ++it)
-    varlist[*it].unuse ();
+    unuse (*it);
 
   /* set UIP */
   uip = aclause.back ();
 
   /*for (guint i = 0; i < aclause.size ()-1; i++)
-    assert (varlist[lit2var (aclause[i])].level < decision_level);*/
+    assert (var_levels[lit2var (aclause[i])] < decision_level);*/
 
   if (aclause.size () >= 2)
   {
@@ -458,7 +1402,8 @@ CDCLModule::derivate_impls (gint32& uip)
     /* add to scored list and to CNF */
     ClauseRef newclause = cref (newclauseptr);
     learned_clauses.push_back (newclauseptr);
-    newclause.score += cl_score_inc;
+    newclause.activity () += cl_score_inc;
+    newclause.glue = compute_glue (aclause);
 
     learned_lits_n += aclause.size ();
   }
@@ -467,7 +1412,7 @@ CDCLModule::derivate_impls (gint32& uip)
   /*for (guint32 i = 0; i < vars_n-1; i++)
   {
     assert (sorted_varlist[i] <= sorted_varlist[i + 1]);
-    assert (i == varlist[sorted_varlist[i].var].sorted);
+    assert (i == var_sorted[sorted_varlist[i].var]);
   }*/
 
   if (to_rescale)
@@ -477,136 +1422,324 @@ CDCLModule::derivate_impls (gint32& uip)
   cl_score_inc *= cl_score_inc_factor;
 
 
-  //assert (varlist[lit2var (uip)].level == decision_level);
+  //assert (var_levels[lit2var (uip)] == decision_level);
+
+  //learned_n++;
+  return shallowest_level;
+}
+
+/*
+ * remove implied literal (first) from reason clause whose all other
+ * literals are in resolvent. clause is watched by two literals
+ * from current level, which will be unassigned after backjump
+ */
+void
+CDCLModule::strengthen_reason (ClausePtr clauseptr)
+{
+  ClauseRef clause = cref (clauseptr);
+  guint32 cl_size = clause.size ();
+
+  delete_from_twl (clauseptr);
+  var_reasons[lit2var (clause[0])] = CLAUSE_NULL;
+  if (!clause.learned ())
+  { /* remove from occurrences of removed literal */
+    WatchedList& occ = occurs[clause[0]];
+    *std::find (occ.begin (), occ.end (), clauseptr) = occ.back ();
+    occ.pop_back ();
+    decrement_occurs (clause[0]);
+  }
+  clause[0] = clause[cl_size-1];
+  clause.shrink (1);
+  clause_bytes -= sizeof (guint32);
+  cl_size--;
+
+  guint32 watched_n = 0;
+  for (guint32 j = 0; j < cl_size && watched_n < 2; j++)
+    if (var_levels[lit2var (clause[j])] == decision_level)
+      std::swap (clause[watched_n++], clause[j]);
+  assert (watched_n == 2);
+  add_to_twl (clauseptr);
+
+  if (clause.learned ())
+  {
+    learned_lits_n--;
+    LitVector lits (&clause[0], &clause[0] + cl_size);
+    clause.glue = std::min (clause.glue, compute_glue (lits));
+  }
+  else
+    orig_literals_n--;
+  strengthened_n++;
+}
+
+/*
+ * minimize clause (based on MiniSat solution)
+ * removable literals are marked as used, not removable as poisoned,
+ * both marks are valid to end of conflict analysis
+ */
+guint32
+CDCLModule::minimize_clause (LitVector& aclause, std::vector<guint32>& used_indices)
+{
+  guint32 shallowest_level;
+  /* mark levels of clause (exactly) */
+  compute_glue (aclause);
+
+  guint ii = 0;
+  for (guint i = 0; i < aclause.size (); i++)
+  {
+    guint32 firstvidx = lit2var (aclause[i]);
+
+    if (var_levels[firstvidx] != decision_level &&
+        var_reasons[firstvidx] != CLAUSE_NULL &&
+        is_removable (firstvidx, used_indices))
+      removed_literals_n++;
+    else
+      aclause[ii++] = aclause[i];
+  }
+  aclause.resize (ii);
+
+  /* recompute compute shallowest level */
+  shallowest_level = 0;
+  LitVector::const_iterator end = --aclause.end ();
+
+  for (LitVector::const_iterator it = aclause.begin (); it != end; ++it)
+    shallowest_level = std::max (shallowest_level, var_levels[lit2var (*it)]);
+
+  return shallowest_level;
+}
+
+/*
+ * check if literal of clause is implied by other literals of clause
+ * (levels of clause must be marked by compute_glue)
+ */
+bool
+CDCLModule::is_removable (guint32 firstvidx, std::vector<guint32>& used_indices)
+{
+  minimize_stack.clear ();
+  minimize_stack.push_back (MinimizeFrame (firstvidx, 1));
+
+  while (!minimize_stack.empty ())
+  {
+    MinimizeFrame& frame = minimize_stack.back ();
+    ClauseRef clause = cref (reason (frame.var));
+    if (frame.next == clause.size ())
+    { /* all antecedents are removable */
+      guint32 vidx = frame.var;
+      minimize_stack.pop_back ();
+      if (vidx != firstvidx)
+      {
+        use (vidx);
+        used_indices.push_back (vidx);
+      }
+      continue;
+    }
+
+    guint32 vidx2 = lit2var (clause[frame.next++]);
+    MYSAT_COUNT (PC_MINIMIZE_STEPS);
+    if (var_levels[vidx2] == 0)
+      continue;
+    if (is_poisoned (vidx2))
+      break;
+    if (is_used (vidx2)) /* in clause or removable */
+      continue;
+    if (var_reasons[vidx2] == CLAUSE_NULL ||
+        level_stamps[var_levels[vidx2]] != level_stamp)
+    { /* decision or level which is not in clause */
+      poison (vidx2);
+      used_indices.push_back (vidx2);
+      break;
+    }
+    minimize_stack.push_back (MinimizeFrame (vidx2, 1));
+  }
+
+  if (minimize_stack.empty ())
+    return true;
 
-  //learned_n++;
-  return shallowest_level;
+  /* all variables on path depend on not removable literal */
+  for (guint32 i = 1; i < minimize_stack.size (); i++)
+  {
+    poison (minimize_stack[i].var);
+    used_indices.push_back (minimize_stack[i].var);
+  }
+  return false;
 }
 
 /*
- * minimize clause (based on MiniSat solution)
+ * shrinking learned clause: literals of every level are replaced by
+ * the UIP of that level if all implications of this block come from
+ * this level or from literals already in clause (all-UIP shrinking).
+ * asserting literal (last) is not changed
  */
-guint32
-CDCLModule::minimize_clause (LiteralVector& aclause, std::vector<guint32>& used_indices)
+void
+CDCLModule::shrink_clause (LitVector& aclause, std::vector<guint32>& used_indices)
 {
-  guint32 shallowest_level;
-  //gint32 uip = aclause.back ();
-  guint32 used_levels = 0;
-  //std::vector<bool> used_levels (decision_level);
-  //std::fill (used_levels.begin (), used_levels.end (), false);
-  for (LiteralConstIter it = aclause.begin (); it != aclause.end (); ++it)
-    used_levels |= (1ULL << (varlist[lit2var (*it)].level & 31));
-    //used_levels[varlist[lit2var (*it)].level] = true;
+  guint32 lits_n = aclause.size ()-1;
+  guint32 asserting = aclause.back ();
+  LevelGreaterFunctor greater (*this);
+  std::sort (aclause.begin (), aclause.begin () + lits_n, greater);
 
-  guint ii = 0;
-  for (guint i = 0; i < aclause.size (); i++)
+  for (guint32 i = 0; i < lits_n; i++)
+    var_used[lit2var (aclause[i])] = USED_CLAUSE;
+
+  /* from highest level, lower levels of clause are not changed yet */
+  LitVector newclause;
+  for (guint32 i = 0; i < lits_n; )
   {
-    bool to_remove = false;
-    guint32 firstvidx = lit2var (aclause[i]);
+    guint32 level = var_levels[lit2var (aclause[i])];
+    guint32 j = i + 1;
+    for (; j < lits_n && var_levels[lit2var (aclause[j])] == level; j++);
+
+    guint32 uip = LIT_UNDEF;
+    if (j - i >= 2 && level != 0)
+      uip = find_level_uip (level, aclause.begin () + i, aclause.begin () + j);
+
+    if (uip != LIT_UNDEF)
+    { /* replace block by negated UIP of this level */
+      for (guint32 k = i; k < j; k++)
+        var_used[lit2var (aclause[k])] = USED_MARK;
+      guint32 uipvar = lit2var (uip);
+      if (!is_used (uipvar))
+        used_indices.push_back (uipvar);
+      var_used[uipvar] = USED_CLAUSE;
+      newclause.push_back (neg (uip));
+      removed_literals_n += j - i - 1;
+    }
+    else
+      newclause.insert (newclause.end (), aclause.begin () + i, aclause.begin () + j);
+    i = j;
+  }
+  newclause.push_back (asserting);
+  aclause.swap (newclause);
 
-    if (varlist[firstvidx].level != decision_level)
-    { /* check if this literal (if removable if not) */
-      std::stack<guint32> impl_stack;
-      impl_stack.push (firstvidx);
+  strengthen_by_binaries (aclause);
 
-      to_remove = true;
-      guint32 first_used_index_in_search = used_indices.size ();
+  for (guint32 i = 0; i < aclause.size ()-1; i++)
+    var_used[lit2var (aclause[i])] = USED_MARK;
+}
 
-      while (!impl_stack.empty ())
-      {
-	guint32 vidx = impl_stack.top ();
-	impl_stack.pop ();
-
-	guint32 pos_stack = varlist[vidx].pos_stack;
-	if (varlist[vidx].level != 0 && assign_stack[pos_stack].clause == CLAUSE_NULL)
-	{ /* if decision assign */
-	  assert (decision_level > varlist[vidx].level);
-	  to_remove = false;
-	  break;
-	}
-	else if (assign_stack[pos_stack].clause == CLAUSE_NULL)
-	{
-	  assert (varlist[vidx].is_used ());
-	  continue;
-	}
+/*
+ * find UIP of level for block of clause literals from this level.
+ * returns LIT_UNDEF if implications depend on literals from lower levels
+ * which are not in clause
+ */
+guint32
+CDCLModule::find_level_uip (guint32 level, LitVector::const_iterator begin,
+        LitVector::const_iterator end)
+{
+  if (++var_stamp == 0)
+  { /* stamp overflow */
+    std::fill (var_stamps, var_stamps + vars_n, 0);
+    var_stamp = 1;
+  }
 
-	ClausePtr clauseptr = assign_stack[pos_stack].clause;
-	ClauseRef clause = cref (clauseptr);
-	guint32 cl_size = clause.size ();
+  guint32 open = 0;
+  for (LitVector::const_iterator it = begin; it != end; ++it)
+  {
+    var_stamps[lit2var (*it)] = var_stamp;
+    open++;
+  }
 
-	for (guint32 k = 0; k < cl_size; k++)
-	{
-	  guint32 vidx2 = lit2var (clause[k]);
-	  /* if not marked then analyze literal, */
-	  if (!varlist[vidx2].is_used () && varlist[vidx2].level != 0)
-	  {
-	    assert (varlist[vidx2].level != 0);
-	    if (varlist[vidx2].assigned () &&
-		//(used_levels[varlist[vidx2].level])
-		((1ULL << (varlist[vidx2].level & 31)) & used_levels) != 0)
-	    { /* if this path is not visited */
-	      assert (varlist[vidx2].assigned ());
-	      impl_stack.push (vidx2);
-	      varlist[vidx2].use ();
-	      used_indices.push_back (vidx2);
-	    }
-	    else
-	    { /* if literals is not part of assert clause */
-	      if (!(varlist[vidx2].level != 0 && !varlist[vidx2].is_used ()))
-	      {
-		std::cout << "Error:" << varlist[vidx2].level << ',' <<
-		    varlist[vidx2].is_used () << ',' << varlist[vidx2].assigned () << std::endl;
-		assert (false);
-	      }
-	      to_remove = false;
-	      break;
-	    }
-	  }
-	}
-      }
-      if (!to_remove) /* not to remove */
+  for (guint32 pos = assign_indices[level+1]; pos > assign_indices[level]; )
+  {
+    pos--;
+    guint32 lit = assign_stack[pos];
+    guint32 vidx = lit2var (lit);
+    if (var_stamps[vidx] != var_stamp)
+      continue;
+    if (open == 1)
+      return lit;
+    open--;
+
+    ClausePtr clauseptr = reason (vidx);
+    assert (clauseptr != CLAUSE_NULL);
+    ClauseRef clause = cref (clauseptr);
+    for (guint32 k = 1; k < clause.size (); k++)
+    {
+      guint32 vidx2 = lit2var (clause[k]);
+      guint32 level2 = var_levels[vidx2];
+      if (level2 == level)
       {
-	for (guint l = first_used_index_in_search; l < used_indices.size (); l++)
-	  varlist[used_indices[l]].unuse ();
-	used_indices.resize (first_used_index_in_search);
+        if (var_stamps[vidx2] != var_stamp)
+        {
+          var_stamps[vidx2] = var_stamp;
+          open++;
+        }
       }
-      else
-	removed_literals_n++;
+      else if (level2 != 0 && var_used[vidx2] != USED_CLAUSE)
+        return LIT_UNDEF;
     }
-
-    if (!to_remove)
-      aclause[ii++] = aclause[i];
   }
-  aclause.resize (ii);
-
-  /* recompute compute shallowest level */
-  shallowest_level = 0;
-  LiteralConstIter end = --aclause.end ();
-
-  for (LiteralConstIter it = aclause.begin (); it != end; ++it)
-    shallowest_level = std::max (shallowest_level, varlist[lit2var (*it)].level);
+  return LIT_UNDEF;
+}
 
-  //assert (aclause.back () == uip);
+/*
+ * removing literals from clause by resolution with binary clauses
+ * containing asserting literal: (asserting or l) removes -l
+ */
+void
+CDCLModule::strengthen_by_binaries (LitVector& aclause)
+{
+  guint32 asserting = aclause.back ();
+  WatchedList& wc = lit2w (asserting);
+  guint32 removed = 0;
+  for (guint32 i = 0; i < wc.size (); i++)
+  {
+    ClauseRef clause = cref (wc[i]);
+    if (clause.size () != 2)
+      continue;
+    guint32 other = (clause[0] == asserting) ? clause[1] : clause[0];
+    guint32 vidx = lit2var (other);
+    if (var_used[vidx] == USED_CLAUSE && istrue (other))
+    {
+      var_used[vidx] = USED_MARK;
+      removed++;
+    }
+  }
+  if (removed == 0)
+    return;
 
-  return shallowest_level;
+  guint32 ii = 0;
+  for (guint32 i = 0; i < aclause.size ()-1; i++)
+    if (var_used[lit2var (aclause[i])] == USED_CLAUSE)
+      aclause[ii++] = aclause[i];
+  aclause[ii++] = asserting;
+  aclause.resize (ii);
+  removed_literals_n += removed;
 }
 
+guint32
+CDCLModule::compute_glue (const LitVector& clause)
+{
+  if (++level_stamp == 0)
+  { /* stamp overflow */
+    std::fill (level_stamps, level_stamps + vars_n + 1, 0);
+    level_stamp = 1;
+  }
+  guint32 glue = 0;
+  for (LitVector::const_iterator it = clause.begin (); it != clause.end (); ++it)
+  {
+    guint32 level = var_levels[lit2var (*it)];
+    if (level_stamps[level] != level_stamp)
+    {
+      level_stamps[level] = level_stamp;
+      glue++;
+    }
+  }
+  return glue;
+}
 
-gint32
+guint32
 CDCLModule::choose_literal ()
 {
   for (sorted_highest = vars_n; sorted_highest > 0; sorted_highest--)
-    if (!varlist[sorted_varlist[sorted_highest-1].var].assigned ())
+    if (!assigned (sorted_varlist[sorted_highest-1].var))
       break;
   sorted_highest--;
 
   ScoredVar& sv = sorted_varlist[sorted_highest];
-  //gint32 lit = (sv.pos_score > sv.neg_score) ? sv.var + 1 : -sv.var - 1;
-  gint32 lit = -sv.var - 1;
-  /*if (do_rand)
-    lit = (rand () & 1) ? -sv.var - 1 : sv.var + 1;*/
+  /* negative literal first */
+  guint32 lit = (sv.var << 1) | 1;
 
-  assert (!varlist[sorted_varlist[sorted_highest].var].assigned ());
+  assert (!assigned (sorted_varlist[sorted_highest].var));
   return lit;
 }
 
@@ -628,7 +1761,7 @@ CDCLModule::rescale_clauses_score ()
   for (guint i = 0; i < learned_clauses.size (); i++)
   {
     ClauseRef ref = cref (learned_clauses[i]);
-    ref.score *= cl_score_divider;
+    ref.activity () *= cl_score_divider;
   }
   /*
   for (ScoredClauseIter it = scored_learned.begin (); it != scored_learned.end (); ++it)
@@ -646,32 +1779,24 @@ CDCLModule::reduce_learned ()
 {
   ClauseLessFunctor lessfunc (*this);
   std::sort (learned_clauses.begin (), learned_clauses.end (), lessfunc);
-  /*for (guint i = 0; i < learned_n; i++)
-    form[scored_learned[i].idx] = i;*/
 
   guint32 to_erase_idx = learned_clauses.size () >> 1;
-  //std::vector<AssignElem>::const_iterator cur_assigned = assigned_clauses.begin ();
 
-  //double litsperclause = double (learned_lits_n) / double (learned_clauses.size ());
   double score_limit = double (cl_score_inc) / (learned_clauses.size ());
 
-  //guint clidx = orig_end;
-  //guint32 newclidx = orig_end;
-  guint32 i = 0;
   guint32 ii = 0;
-  for (i = 0; i < to_erase_idx; i++)
+  for (guint32 i = 0; i < learned_clauses.size (); i++)
   {
     ClausePtr clauseptr = learned_clauses[i];
     ClauseRef clause = cref (clauseptr);
 
     bool to_remove = false;
-    if (clause.size () > 2)
-    {
-      guint32 posstack = varlist[lit2var (clause[0])].pos_stack;
-      /* if resolved by propagation */
-      if (posstack >= assign_stack.size () || assign_stack[posstack].clause != clauseptr)
-	to_remove = true;
-    }
+    /* satisfied at level 0 (removed here, not in simplify_formulae) */
+    for (guint32 j = 0; j < clause.size () && !to_remove; j++)
+      to_remove = istrue (clause[j]) && var_levels[lit2var (clause[j])] == 0;
+    /* if resolved by propagation: first half or with small score */
+    if (!to_remove && clause.size () > 2 && !is_reason (clauseptr))
+      to_remove = i < to_erase_idx || clause.activity () < score_limit;
     if (!to_remove)
       learned_clauses[ii++] = clauseptr;
     else
@@ -681,33 +1806,66 @@ CDCLModule::reduce_learned ()
       delete_clause (clauseptr);
     }
   }
-  for (; i < learned_clauses.size (); i++)
+  learned_clauses.resize (ii);
+  after_first_reduce = true;
+}
+
+void
+CDCLModule::compact_memory ()
+{
+  for (guint32 l = 0; l < (vars_n<<1); l++)
   {
-    ClausePtr clauseptr = learned_clauses[i];
-    ClauseRef clause = cref (clauseptr);
+    WatchedList& wc = watched[l];
+    if (wc.capacity () > 2*wc.size () + 4)
+      WatchedList (wc).swap (wc);
+  }
+  std::vector<ClausePtr> (learned_clauses).swap (learned_clauses);
+  std::vector<ClausePtr> (orig_clauses).swap (orig_clauses);
+}
 
-    bool to_remove = false;
-    if (clause.size () > 2)
+void
+CDCLModule::init_assumptions ()
+{
+  assumptions.clear ();
+  for (guint32 i = 0; i < assumed_literals.size (); i++)
+    /* variables not in formula can be always assumed */
+    if (lit2var (dimacs2lit (assumed_literals[i])) < vars_n)
+      assumptions.push_back (dimacs2lit (assumed_literals[i]));
+  next_assumption = 0;
+  failed_assumptions.clear ();
+}
+
+/*
+ * false assumption is implied by decisions (earlier assumptions)
+ * from its reasons
+ */
+void
+CDCLModule::analyze_final (guint32 lit)
+{
+  failed_assumptions.assign (1, lit2dimacs (lit));
+  if (var_levels[lit2var (lit)] == 0)
+    return;
+  std::vector<bool> seen (vars_n, false);
+  seen[lit2var (lit)] = true;
+  for (guint32 i = assign_stack.size (); i > assign_indices[1]; i--)
+  {
+    guint32 var = lit2var (assign_stack[i-1]);
+    if (!seen[var])
+      continue;
+    ClausePtr clauseptr = reason (var);
+    if (clauseptr == CLAUSE_NULL)
     {
-      guint32 posstack = varlist[lit2var (clause[0])].pos_stack;
-      /* if resolved by propagation */
-      if ((posstack >= assign_stack.size () || assign_stack[posstack].clause != clauseptr)
-	  && (/*double (clause.size ()) >= litsperclause*1.333 ||*/
-	    clause.score < score_limit))
-	to_remove = true;
+      failed_assumptions.push_back (lit2dimacs (assign_stack[i-1]));
+      continue;
     }
-    if (!to_remove)
-      learned_clauses[ii++] = clauseptr;
-    else
+    ClauseRef clause = cref (clauseptr);
+    for (guint32 j = 0; j < clause.size (); j++)
     {
-      learned_lits_n -= clause.size ();
-      delete_from_twl (clauseptr);
-      delete_clause (clauseptr);
+      guint32 v = lit2var (clause[j]);
+      if (v != var && var_levels[v] != 0)
+        seen[v] = true;
     }
   }
-
-  learned_clauses.resize (ii);
-  after_first_reduce = true;
 }
 
 /*
@@ -720,106 +1878,114 @@ CDCLModule::simplify_formulae ()
   Result prop_result;
 
   /* after this propagate (BCP) */
-  prop_result = do_propagate (0);
+  prop_result = do_propagate (LIT_UNDEF);
   if (prop_result == UNSATISFIABLE)
     return UNSATISFIABLE;
 
-  std::vector<bool> varscount (vars_n);
-  std::fill (varscount.begin (), varscount.end (), false);
-
-  /* delete satisfied clauses from original formulae */
-  guint32 ii = 0;
-  for (guint32 i = 0; i < orig_clauses.size (); i++)
+  /* visit only clauses with new level 0 literals */
+  while (simplified_n < assign_stack.size () || !pure_candidates.empty ())
   {
-    ClausePtr clauseptr = orig_clauses[i];
-    ClauseRef clause = cref (clauseptr);
-
-    bool satisfied = false;
-    guint32 cl_size = clause.size ();
-    for (guint j = 0; j < cl_size; j++)
-      if (istrue (clause[j]))
-      {
-	satisfied = true;
-	break;
-      }
-
-    if (satisfied)
-    { /* to remove */
-      if (cl_size >= 2)
-        delete_from_twl (clauseptr);
-      delete_clause (clauseptr);
-      orig_literals_n -= cl_size;
+    for (; simplified_n < assign_stack.size (); simplified_n++)
+      remove_satisfied (assign_stack[simplified_n]);
+    purge_satisfied ();
+
+    /* assign pure and unused variables */
+    guint32 applied = 0;
+    if (incremental)
+      pure_candidates.clear ();
+    for (guint32 i = 0; i < pure_candidates.size (); i++)
+    {
+      guint32 var = pure_candidates[i];
+      if (assigned (var))
+        continue;
+      guint32 lit;
+      if (occurs_n[(var<<1) | 1] == 0)
+        lit = var<<1;
+      else if (occurs_n[var<<1] == 0)
+        lit = (var<<1) | 1;
+      else
+        continue;
+      applied++;
+      assign (CLAUSE_NULL, lit);
+      impl_queue.push_back (Implicate (CLAUSE_NULL, lit));
     }
-    else
-    { /* counting vars */
-      for (guint j = 0; j < cl_size; j++)
-	if (value (clause[j]) == 0)
-	  varscount[lit2var (clause[j])] = true;
-      orig_clauses[ii++] = orig_clauses[i];
+    pure_candidates.clear ();
+
+    if (applied != 0)
+    {
+      prop_result = do_propagate (LIT_UNDEF);
+      if (prop_result == UNSATISFIABLE)
+        return UNSATISFIABLE;
     }
   }
-  orig_clauses.resize (ii);
 
-  /* delete satisfied learned clauses */
-  ii = 0;
-  for (guint32 i = 0; i < learned_clauses.size (); i++)
+  used_vars_n = vars_n - assign_stack.size ();
+  return prop_result;
+}
+
+void
+CDCLModule::remove_satisfied (guint32 lit)
+{
+  WatchedList& occ = occurs[lit];
+  for (guint32 i = 0; i < occ.size (); i++)
   {
-    ClausePtr clauseptr = learned_clauses[i];
+    ClausePtr clauseptr = occ[i];
     ClauseRef clause = cref (clauseptr);
+    if (clause.garbage ())
+      continue;
 
-    bool satisfied = false;
     guint32 cl_size = clause.size ();
-    for (guint j = 0; j < cl_size; j++)
-      if (istrue (clause[j]))
+    clause.set_garbage ();
+    orig_garbage_n++;
+    orig_literals_n -= cl_size;
+    if (cl_size >= 2)
+      delete_from_twl (clauseptr);
+    for (guint32 j = 0; j < cl_size; j++)
+    {
+      guint32 l = clause[j];
+      decrement_occurs (l);
+      if (!occurs_dirty[l])
       {
-	satisfied = true;
-	break;
+        occurs_dirty[l] = true;
+        dirty_occurs.push_back (l);
       }
-
-    if (satisfied)
-    { /* to remove */
-      learned_lits_n -= clause.size ();
-      if (cl_size >= 2)
-        delete_from_twl (clauseptr);
-      delete_clause (clauseptr);
-    }
-    else
-    {
-      for (guint j = 0; j < cl_size; j++)
-	if (value (clause[j]) == 0)
-	  varscount[lit2var (clause[j])] = true;
-      learned_clauses[ii++] = learned_clauses[i];
     }
   }
-  learned_clauses.resize (ii);
-  guint32 applied = 0;
-  used_vars_n = 0;
-  for (guint i = 0; i < vars_n; i++)
-    if (varscount[i])
-    {
-      if (!varlist[i].assigned ())
-        used_vars_n++;
-      else
-	assert (false);
-    }
-    else if (!varlist[i].assigned ())
-    {
-      applied++;
-      assign (CLAUSE_NULL, i+1);
-      impl_queue.push_back (Implicate (CLAUSE_NULL, i+1));
-    }
-
-  /* sort sorted_varlist */
-  std::sort (sorted_varlist, sorted_varlist + vars_n);
-  for (guint32 i = 0; i < vars_n; i++)
-    varlist[sorted_varlist[i].var].sorted = i;
+  /* literals of assigned variable never will be visited */
+  WatchedList ().swap (occ);
+  WatchedList ().swap (occurs[neg (lit)]);
+}
 
-  for (sorted_highest = vars_n; sorted_highest > 0; sorted_highest--)
-    if (!varlist[sorted_varlist[sorted_highest-1].var].assigned ())
-      break;
-  sorted_highest--;
+void
+CDCLModule::purge_satisfied ()
+{
+  for (guint32 i = 0; i < dirty_occurs.size (); i++)
+  {
+    guint32 l = dirty_occurs[i];
+    WatchedList& occ = occurs[l];
+    guint32 ii = 0;
+    for (guint32 k = 0; k < occ.size (); k++)
+      if (!cref (occ[k]).garbage ())
+        occ[ii++] = occ[k];
+    occ.resize (ii);
+    occurs_dirty[l] = false;
+  }
+  dirty_occurs.clear ();
 
-  return prop_result;
+  /* free satisfied clauses if many of them */
+  if (orig_garbage_n == 0 || orig_garbage_n < (orig_clauses.size () >> 2))
+    return;
+  guint32 ii = 0;
+  for (guint32 i = 0; i < orig_clauses.size (); i++)
+  {
+    ClausePtr clauseptr = orig_clauses[i];
+    if (cref (clauseptr).garbage ())
+      delete_clause (clauseptr);
+    else
+      orig_clauses[ii++] = clauseptr;
+  }
+  orig_clauses.resize (ii);
+  orig_garbage_n = 0;
 }
 
 void
@@ -833,7 +1999,7 @@ CDCLModule::report_progress (bool newrestart) const
 	std::setw (9) << decision_count << '|' <<
 	std::setw (8) << conflict_count << '|' <<
 	std::setw (6) << used_vars_n << '|' <<
-	std::setw (8) << orig_clauses.size () << '|' <<
+	std::setw (8) << (orig_clauses.size () - orig_garbage_n) << '|' <<
 	std::setw (8) << orig_literals_n << '|' <<
 	std::setw (8) << learned_clauses.size () << '|' <<
 	std::setw (8) << learned_lits_n << '|' <<
@@ -845,6 +2011,23 @@ CDCLModule::report_progress (bool newrestart) const
   signal_progress_def.emit (os.str ());
 }
 
+void
+CDCLModule::publish_cdcl_stats ()
+{
+  SolverStats stats;
+  stats.decisions = decision_count;
+  stats.conflicts = total_conflicts_n;
+  stats.propagations = propagations_n;
+  stats.restarts = restarts_n;
+  stats.learned_clauses = learned_clauses.size ();
+  stats.learned_literals = learned_lits_n;
+  stats.trail_size = assign_stack.size ();
+  stats.ticks = ticks_n;
+  stats.memory = used_bytes ();
+  stats.peak_memory = peak_bytes;
+  publish_stats (stats);
+}
+
 /*
  * main solve routine
  */
@@ -852,13 +2035,33 @@ CDCLModule::report_progress (bool newrestart) const
 Result
 CDCLModule::solve (std::vector<bool>& model)
 {
-  if (initialize () == UNSATISFIABLE)
+  if (inconsistent)
     return UNSATISFIABLE;
-
-  assign_indices.push_back (0);
+  if (!incremental || !initialized)
+  {
+    initialized = true;
+    if (initialize () == UNSATISFIABLE)
+    {
+      inconsistent = true;
+      return UNSATISFIABLE;
+    }
+    assign_indices.push_back (0);
+  }
+  else
+  {
+    /* continue from level 0 of previous solve */
+    init_assumptions ();
+  }
+  next_memory_check = 0;
+  memory_check_interval = 256;
+  learned_cap = G_MAXUINT64;
 
   decision_count = 0;
   conflict_count = 0;
+  total_conflicts_n = 0;
+  propagations_n = 0;
+  ticks_n = 0;
+  start_budget ();
 
   signal_progress_def.emit (
 	"--------------------------------------------------------------------------------------------------");
@@ -868,7 +2071,7 @@ CDCLModule::solve (std::vector<bool>& model)
 	"--------------------------------------------------------------------------------------------------");
 
   Result prop_result;
-  gint32 choosen = 0;
+  guint32 choosen = LIT_UNDEF;
 
   guint32 initial_factor = 1;
 
@@ -882,7 +2085,9 @@ CDCLModule::solve (std::vector<bool>& model)
   {
     prop_result = simplify_formulae ();
     if (learn_start == 0)
-      max_learned = (orig_clauses.size () * learn_factor);
+      /* clauses replaced by detected XORs and constraints are counted */
+      max_learned = ((orig_clauses.size () + xor_clauses_n + card_clauses_n) *
+            learn_factor);
     else
       max_learned = learn_start;
   }
@@ -900,15 +2105,63 @@ CDCLModule::solve (std::vector<bool>& model)
       {
 	reduce_learned ();
 	if (restart_strategy == RESTARTS_RSAT)
-	  max_learned += (max_learned / 10);
+	  set_max_learned (max_learned + (max_learned / 10));
+      }
+      else if (total_conflicts_n >= next_memory_check && memory_pressure ())
+      {
+	/* near memory limit: reduce now and keep learned database smaller */
+	guint64 learned_n = learned_clauses.size ();
+	reduce_learned ();
+	compact_memory ();
+	learned_cap = std::min (learned_cap,
+	      guint64 (assign_stack.size () + learned_n - (learned_n >> 2)));
+	max_learned = std::min (max_learned, learned_cap);
+	memory_reduces_n++;
+	if (used_bytes () >= get_budget ().memory)
+	{
+	  /* learned clauses cannot be reduced below memory limit */
+	  set_stop_reason ("memory");
+	  prop_result = UNKNOWN;
+	  break;
+	}
+	/* check less often if reduce doesnt help */
+	if (memory_pressure ())
+	  memory_check_interval = std::min (memory_check_interval << 1,
+	        guint64 (65536));
+	else
+	  memory_check_interval = 256;
+	next_memory_check = total_conflicts_n + memory_check_interval;
+      }
+
+      /* assumptions are decided first */
+      choosen = LIT_UNDEF;
+      for (; next_assumption < assumptions.size () &&
+	   istrue (assumptions[next_assumption]); next_assumption++);
+      if (next_assumption < assumptions.size ())
+      {
+	choosen = assumptions[next_assumption];
+	if (value (choosen) == FLAGS_FALSE)
+	{
+	  analyze_final (choosen);
+	  prop_result = UNSATISFIABLE;
+	  break;
+	}
       }
 
-      if (assign_stack.size () != vars_n)
+      if (choosen != LIT_UNDEF || assign_stack.size () != vars_n)
       {
-	choosen = choose_literal ();
+	if (budget_exhausted (total_conflicts_n, propagations_n, ticks_n))
+	{
+	  prop_result = UNKNOWN;
+	  break;
+	}
+	if (choosen == LIT_UNDEF)
+	  choosen = choose_literal ();
 	assign_indices.push_back (assign_stack.size ());
 	decision_level++;
 	decision_count++;
+	if ((decision_count & 0xff) == 0)
+	  publish_cdcl_stats ();
 	if ((decision_count & 0xfff) == 0)
 	  report_progress (false);
       }
@@ -918,12 +2171,20 @@ CDCLModule::solve (std::vector<bool>& model)
     else
     {
       conflict_count++;
+      total_conflicts_n++;
+      if ((total_conflicts_n & 0xff) == 0)
+        publish_cdcl_stats ();
       //local_conflict_count++;
       if (decision_level != 0)
       {
+	if (budget_exhausted (total_conflicts_n, propagations_n, ticks_n))
+	{
+	  prop_result = UNKNOWN;
+	  break;
+	}
 	if (conflict_count < max_conflicts_n)
 	{
-	  gint32 uip;
+	  guint32 uip;
 	  guint32 undo_level = derivate_impls (uip);
 	  undo_propagate (undo_level);
 
@@ -932,7 +2193,7 @@ CDCLModule::solve (std::vector<bool>& model)
 
 	  assign (clauseptr, uip);
 	  impl_queue.push_back (Implicate (clauseptr, uip)); /* for finish BCP */
-	  choosen = 0;
+	  choosen = LIT_UNDEF;
 	  if (decision_level == 0)
 	  {
 	    prop_result = simplify_formulae ();
@@ -952,7 +2213,7 @@ CDCLModule::solve (std::vector<bool>& model)
 	  if (restart_strategy == RESTARTS_MINISAT)
 	  {
 	    /*if (after_first_reduce)*/
-	    max_learned += (max_learned / 10);
+	    set_max_learned (max_learned + (max_learned / 10));
 	    report_progress (true);
 
 	    //max_conflicts_n += guint32 (double (max_conflicts_n) / 2);
@@ -977,7 +2238,8 @@ CDCLModule::solve (std::vector<bool>& model)
 	    {
 	      outer += outer / 10;
 	      max_conflicts_n = double (orig_clauses.size ()) * learn_factor * my_factor;
-	      max_learned = double (orig_clauses.size ()) * learn_factor * my_factor;
+	      set_max_learned (guint64 (double (orig_clauses.size ()) *
+	            learn_factor * my_factor));
 	      my_factor *= 1.03;
 	      report_progress (true);
 	    }
@@ -985,11 +2247,11 @@ CDCLModule::solve (std::vector<bool>& model)
 	    {
 	      report_progress (true);
 	      max_conflicts_n += max_conflicts_n / 5;
-	      max_learned += max_learned / 5;
+	      set_max_learned (max_learned + max_learned / 5);
 	    }
 	  }
 
-	  choosen = 0;
+	  choosen = LIT_UNDEF;
 	}
       }
       else
@@ -999,13 +2261,158 @@ CDCLModule::solve (std::vector<bool>& model)
   }
 
   report_progress (false);
+  publish_cdcl_stats ();
+  {
+    std::ostringstream os;
+    os << "Memory: " << (used_bytes () >> 10) << " kB, peak: " <<
+        (peak_bytes >> 10) << " kB, memory reduces: " << memory_reduces_n;
+    signal_progress_def.emit (os.str ());
+  }
+  if (!xor_matrices.empty ())
+  {
+    guint32 rows_n = 0, gauss_n = 0;
+    guint64 pivots_n = 0;
+    for (guint32 m = 0; m < xor_matrices.size (); m++)
+    {
+      rows_n += xor_matrices[m].get_rows_n ();
+      gauss_n += (xor_matrices[m].is_gauss ()) ? 1 : 0;
+      pivots_n += xor_matrices[m].get_pivots_n ();
+    }
+    std::ostringstream os;
+    os << "XORs: " << rows_n << " rows, detected: " << detected_xors_n <<
+        ", matrices: " << xor_matrices.size () << ", gauss: " << gauss_n <<
+        ", pivots: " << pivots_n;
+    signal_progress_def.emit (os.str ());
+  }
+  if (!pb_starts.empty ())
+  {
+    guint32 cards_n = 0;
+    for (guint32 i = 0; i < pb_starts.size (); i++)
+      if (orig_pbs[pb_starts[i] + 1] == 1)
+        cards_n++;
+    std::ostringstream os;
+    os << "Linear constraints: " << pb_starts.size () << " (cardinality: " <<
+        cards_n << "), detected: " << detected_cards_n <<
+        ", replaced clauses: " << card_clauses_n;
+    signal_progress_def.emit (os.str ());
+  }
+#ifdef MYSAT_COUNTERS
+  {
+    std::istringstream is (perf_counters.to_string ());
+    std::string line;
+    while (std::getline (is, line))
+      signal_progress_def.emit (line);
+  }
+#endif
+
+  if (prop_result == SATISFIABLE)
+    /* all variables can be assigned before deciding assumptions */
+    for (guint32 i = 0; i < assumptions.size (); i++)
+      if (!istrue (assumptions[i]))
+      {
+	analyze_final (assumptions[i]);
+	prop_result = UNSATISFIABLE;
+	break;
+      }
 
   if (prop_result == SATISFIABLE)
   {
     model.resize (vars_n);
     for (guint i = 0; i < vars_n; i++)
-      model[i] = varlist[i].get ();
+      model[i] = istrue (i<<1);
+  }
+  else if (prop_result == UNSATISFIABLE && failed_assumptions.empty ())
+    inconsistent = true; /* conflict at level 0 */
+
+  if (incremental && !inconsistent)
+  {
+    /* next solve or added clauses start at level 0 */
+    undo_propagate (0);
+    impl_queue.clear ();
+    current_conflict = CLAUSE_NULL;
   }
 
   return prop_result;
 }
+
+bool
+CDCLModule::set_incremental ()
+{
+  if (initialized && !incremental)
+    return false;
+  incremental = true;
+  return true;
+}
+
+/*
+ * add clause between incremental solves (at level 0): literals false
+ * at level 0 are removed, unit clause is assigned and propagated
+ * by next solve.
+ */
+void
+CDCLModule::add_clause (const LiteralVector& literals)
+{
+  LitVector clause;
+  for (guint32 i = 0; i < literals.size (); i++)
+  {
+    if (literals[i] == 0 || guint32 (std::abs (literals[i])) > vars_n)
+      throw ModuleError (ModuleError::BAD_VALUE,
+            "Literal of added clause is out of range");
+    clause.push_back (dimacs2lit (literals[i]));
+  }
+  std::sort (clause.begin (), clause.end ());
+  clause.erase (std::unique (clause.begin (), clause.end ()), clause.end ());
+
+  if (!initialized)
+  { /* before first solve: clause is original clause */
+    if (clause.empty ())
+      inconsistent = true;
+    else
+    {
+      orig_clauses.push_back (create_clause (clause.size (), clause.begin ()));
+      orig_literals_n += clause.size ();
+    }
+    return;
+  }
+  if (!incremental)
+    throw ModuleError (ModuleError::OTHER_ERROR,
+          "Clauses can be added only in incremental solving");
+  if (inconsistent)
+    return;
+
+  guint32 size = 0;
+  for (guint32 i = 0; i < clause.size (); i++)
+  {
+    guint32 lit = clause[i];
+    /* tautology (negation of literal is next after sorting) */
+    if (i+1 < clause.size () && clause[i+1] == neg (lit))
+      return;
+    guint32 value_lit = value (lit);
+    if (value_lit == FLAGS_TRUE)
+      return; /* satisfied at level 0 */
+    if (value_lit != FLAGS_FALSE)
+      clause[size++] = lit;
+  }
+  clause.resize (size);
+  if (size == 0)
+  {
+    inconsistent = true;
+    return;
+  }
+
+  ClausePtr clauseptr = create_clause (size, clause.begin ());
+  orig_clauses.push_back (clauseptr);
+  orig_literals_n += size;
+  for (guint32 i = 0; i < size; i++)
+  {
+    occurs[clause[i]].push_back (clauseptr);
+    occurs_n[clause[i]]++;
+  }
+  if (size >= 2)
+    add_to_twl (clauseptr);
+  else
+  {
+    assign (clauseptr, clause[0]);
+    impl_queue.push_back (Implicate (clauseptr, clause[0]));
+  }
+}
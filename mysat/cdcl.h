@@ -8,17 +8,39 @@
 #define __MYSAT_CDCL_H__
 
 #include <assert.h>
+#include <algorithm>
 #include <deque>
 #include <string>
 #include <vector>
 #include <glibmm.h>
 #include "module.h"
+#include "perf-counters.h"
+#include "xor-matrix.h"
 
 #define CLAUSE_NULL (reinterpret_cast<ClausePtr>(0))
+/* reason of implication by linear constraint (created when needed) */
+#define CLAUSE_PB (reinterpret_cast<ClausePtr>(1))
+/* no literal (for do_propagate) */
+#define LIT_UNDEF G_MAXUINT32
 
 class CDCLModule: public MySatModule
 {
 private:
+  /*
+   * internal literals are unsigned: 2*var + sign (sign is 1 for negation).
+   * DIMACS literals are converted only in fetch_problem and in model.
+   */
+  typedef std::vector<guint32> LitVector;
+
+  static guint32 dimacs2lit (gint32 l)
+  { return (l >= 0) ? ((l-1)<<1) : (((-l-1)<<1) | 1); }
+  static gint32 lit2dimacs (guint32 l)
+  { return (l & 1) ? -gint32 ((l>>1)+1) : gint32 ((l>>1)+1); }
+  static guint32 neg (guint32 l)
+  { return l ^ 1; }
+  static guint32 lit2var (guint32 l)
+  { return l >> 1; }
+
   //class Clause;
 
   class Clause
@@ -27,45 +49,83 @@ private:
     typedef Clause &Ref;
     typedef Clause *Ptr;
 
-    double score;
+    enum {
+      LEARNED = 1,
+      GARBAGE = 2,
+      USED = 4,
+      TEMPORARY = 8, /* reason or conflict from XOR, freed on backtracking */
+      FLAGS_BITS = 4
+    };
+
+    /*
+     * 8-byte header: size with flags and glue (LBD).
+     * learned clauses have float activity placed before header.
+     */
     guint32 n;
-    gint32 lits[0];
-
-    Clause () : score (0), n (1)
-    { }
-    Clause (int lits_n, bool learn = false) : score (0), n (lits_n | ((learn) ? 1 : 0))
-    { }
+    guint32 glue;
+    guint32 lits[0];
 
-    void init (int lits_n, bool learn = false)
+    void init (guint32 lits_n, bool learn = false)
     {
-      score = 0;
-      n = (lits_n<<1) | ((learn) ? 1 : 0);
+      n = (lits_n<<FLAGS_BITS) | ((learn) ? LEARNED : 0);
+      glue = 0;
+      if (learn)
+        activity () = 0.0f;
     }
 
-    gint32& operator[] (guint32 i)
+    guint32& operator[] (guint32 i)
     { return lits[i]; }
-    const gint32& operator[] (guint32 i) const
+    const guint32& operator[] (guint32 i) const
     { return lits[i]; }
 
     guint32 size () const
-    { return n>>1; }
+    { return n>>FLAGS_BITS; }
 
     void shrink (guint32 lits_n)
-    { n -= lits_n<<1; }
+    { n -= lits_n<<FLAGS_BITS; }
 
     bool learned () const
-    { return (n & 1) != 0; }
+    { return (n & LEARNED) != 0; }
+    bool garbage () const
+    { return (n & GARBAGE) != 0; }
+    void set_garbage ()
+    { n |= GARBAGE; }
+    bool used () const
+    { return (n & USED) != 0; }
+    void set_used (bool u)
+    { n = (u) ? (n | USED) : (n & ~guint32 (USED)); }
+    bool temporary () const
+    { return (n & TEMPORARY) != 0; }
+    void set_temporary ()
+    { n |= TEMPORARY; }
+
+    /* only for learned clauses */
+    float& activity ()
+    { return reinterpret_cast<float*>(this)[-1]; }
+    float activity () const
+    { return reinterpret_cast<const float*>(this)[-1]; }
   };
 
   typedef Clause::Ref ClauseRef;
   typedef Clause::Ptr ClausePtr;
 
+  /* accounted memory of clause with its two watches */
+  static guint32 clause_mem_size (guint32 lits_n, bool learn)
+  {
+    return ((learn) ? sizeof (float) : 0) + sizeof (Clause) +
+        sizeof (guint32) * lits_n + 2 * sizeof (ClausePtr);
+  }
+
   ClausePtr create_clause_n (guint32 lits_n, bool learn = false)
   {
-    guint32 sz = sizeof (double) + sizeof (gint32) * (lits_n + 1);
+    guint32 extra = (learn) ? sizeof (float) : 0;
+    guint32 sz = extra + sizeof (Clause) + sizeof (guint32) * lits_n;
     guchar* m = new guchar[sz];
+    clause_bytes += clause_mem_size (lits_n, learn);
+    if (fixed_bytes + clause_bytes > peak_bytes)
+      peak_bytes = fixed_bytes + clause_bytes;
 
-    ClausePtr ptr = (reinterpret_cast<Clause*>(m));
+    ClausePtr ptr = (reinterpret_cast<Clause*>(m + extra));
     ptr->init (lits_n, learn);
     return ptr;
   }
@@ -81,28 +141,30 @@ private:
   }
 
   /* clause reference */
-  ClauseRef cref (ClausePtr ptr)
+  ClauseRef cref (ClausePtr ptr) const
   {
     return *ptr;
   }
 
   void delete_clause (ClausePtr c)
   {
-//#if 0
     ClauseRef clause = cref (c);
-    //if (clause.size () >= 2)
-    {
-      /*guint32 implvidx = (clause.size () >= 2) ? lit2var (clause[0]) :
-	lit2var (clause[0]);*/
-      guint32 implvidx = lit2var (clause[0]);
-      guint32 pos_stack = varlist[implvidx].pos_stack;
-      /* if pos_stack is good and if clause in assign stack item is c then
-       * clause to null in stack item */
-      if (pos_stack < assign_stack.size () && assign_stack[pos_stack].clause == c)
-	assign_stack[pos_stack].clause = CLAUSE_NULL;
-    }
-//#endif
-    delete[] reinterpret_cast<guchar*>(c);
+    /* if clause is reason of assignment then clause to null in reasons */
+    guint32 implvidx = lit2var (clause[0]);
+    if (var_reasons[implvidx] == c)
+      var_reasons[implvidx] = CLAUSE_NULL;
+    free_clause (c);
+  }
+
+  /* free clause memory only */
+  void free_clause (ClausePtr c)
+  {
+    ClauseRef clause = cref (c);
+    guint32 extra = (clause.learned ()) ? sizeof (float) : 0;
+    clause_bytes -= clause_mem_size (clause.size (), clause.learned ());
+    MYSAT_COUNT_ADD (PC_GC_BYTES,
+        extra + sizeof (Clause) + sizeof (guint32) * clause.size ());
+    delete[] (reinterpret_cast<guchar*>(c) - extra);
   }
 
   void add_to_twl (ClausePtr clauseptr)
@@ -123,6 +185,19 @@ private:
     wc2.resize (wc2.size () - 1);
   }
 
+  struct LevelGreaterFunctor
+  {
+    const CDCLModule& cdcl_mod;
+
+    LevelGreaterFunctor (const CDCLModule& m) : cdcl_mod (m)
+    { }
+
+    bool operator() (guint32 l1, guint32 l2) const
+    {
+      return cdcl_mod.var_levels[lit2var (l1)] > cdcl_mod.var_levels[lit2var (l2)];
+    }
+  };
+
   struct ClauseLessFunctor
   {
     CDCLModule& cdcl_mod;
@@ -132,7 +207,7 @@ private:
 
     bool operator() (const ClausePtr& c1, const ClausePtr& c2)
     {
-      return cdcl_mod.cref (c1).score < cdcl_mod.cref (c2).score;
+      return cdcl_mod.cref (c1).activity () < cdcl_mod.cref (c2).activity ();
     }
   };
 
@@ -141,12 +216,12 @@ private:
     FLAGS_FALSE = 2,
     FLAGS_TRUE = 1,
     FLAGS_VALMASK = 3,
-    FLAGS_USED = 4,
   };
 
   enum {
     NO_CONFLICT = G_MAXUINT32,
-    NO_CLAUSES = G_MAXUINT32
+    NO_CLAUSES = G_MAXUINT32,
+    NO_PB = G_MAXUINT32
   };
 
   //static const ClausePtr CLAUSE_NULL = reinterpret_cast<const ClausePtr>(0);
@@ -160,15 +235,35 @@ private:
 
   float learn_factor;
   guint learn_start;
+  /* distance (in watched list) of prefetched clause, zero - no prefetching */
+  guint prefetch_dist;
+  /* if shrink learned clauses */
+  bool do_shrink;
+  /* if strengthen reasons during conflict analysis */
+  bool do_otfs;
   std::string restart_strategy_string;
   RestartStrategy restart_strategy;
+  /* if keep XOR matrix in reduced row echelon form */
+  bool do_gauss;
+  /* max size of clauses encoding detected XORs (0 - no detection) */
+  guint xor_detect;
+  /* min size of detected at most one constraints (0 - no detection) */
+  guint card_detect;
 
   guint32 vars_n;
   guint32 decision_level;
   ClausePtr current_conflict;
   guint64 decision_count;
-  guint64 conflict_count;
+  guint64 conflict_count; /* conflicts since restart */
+  guint64 total_conflicts_n;
+  guint64 propagations_n;
+  /* deterministic work: watch lists, clauses and cache lines visited in BCP */
+  guint64 ticks_n;
+#ifdef MYSAT_COUNTERS
+  PerfCounters perf_counters;
+#endif
   guint64 removed_literals_n;
+  guint64 strengthened_n; /* clauses strengthened on-the-fly */
 
   //guint32 orig_clauses_n;
   guint32 restarts_n;
@@ -182,8 +277,137 @@ private:
 
   guint32 used_vars_n;
 
+  /* XOR constraints: size, rhs, variables */
+  LitVector orig_xors;
+  guint32 detected_xors_n;
+  guint32 xor_clauses_n; /* clauses replaced by detected XORs */
+  /* matrices of connected components of XORs */
+  std::vector<XorMatrix> xor_matrices;
+  std::vector<guint32> var_xor_matrix; /* NONE if variable is not in XORs */
+  std::vector<guint32> var_xor_col;
+  XorMatrix::ImplVector xor_impls;
+  LitVector xor_vars;
+
+  /* temporary reasons and conflicts built from XOR and PB constraints
+   * with their trail positions (deleted when undone) */
+  std::vector<std::pair<guint32, ClausePtr> > temp_reasons;
+
+  /* add XOR of DIMACS literals (normalized: variables appear once) */
+  void add_xor (guint32 lits_n, const gint32* literals);
+  /* replace clauses encoding XORs by XORs */
+  void detect_xors ();
+  guint32 xor_rows_n () const;
+  /* connected components of XORs: component of every row, returns number */
+  guint32 xor_components (std::vector<guint32>& row_comps) const;
+  /*
+   * elimination pays off only if XORs dominate constraints of their
+   * variables, otherwise implications are mostly found by clauses.
+   * detected XORs are used only with elimination.
+   */
+  static bool xors_dominate (guint64 clause_occs, guint64 xor_lits)
+  { return clause_occs <= xor_lits; }
+  /* build XOR matrices, returns false if XORs are inconsistent */
+  bool init_xor_matrices ();
+  /* temporary clause from row: implied literal first (or LIT_UNDEF) */
+  ClausePtr xor_clause (const XorMatrix& matrix, guint32 row, guint32 implied);
+  /* assign implications of matrix, returns false if conflict */
+  bool assign_xor_impls (const XorMatrix& matrix);
+  /* XOR propagation after assigning variable */
+  Result xor_propagate (guint32 var);
+
+  /*
+   * linear constraints (cardinality and pseudo-Boolean): sum of weights
+   * of true literals is at most bound, stored as: bound, max weight, size,
+   * weights and literals (sorted by weight descending). constraint sums
+   * weights of true literals from the trail prefix of pb_counted_n
+   * literals (in order of BCP). literals whose weight exceeds slack
+   * (bound minus sum) are implied to be false, constraint is visited
+   * only if slack is less than max weight. reasons of these implications
+   * are created only in conflict analysis from literals counted before
+   * implication and freed on backtracking.
+   */
+  std::vector<guint64> orig_pbs;
+  guint32 detected_cards_n;
+  guint32 card_clauses_n; /* binary clauses replaced by detected constraints */
+  struct PBOccur
+  {
+    guint32 pb;
+    guint64 weight;
+    PBOccur (guint32 inpb, guint64 inweight) : pb (inpb), weight (inweight)
+    { }
+  };
+  typedef std::vector<PBOccur> PBOccurList;
+  /* orders terms (literal, weight) by weight descending */
+  struct ByWeight
+  {
+    bool operator() (const std::pair<guint32, gint64>& t1,
+          const std::pair<guint32, gint64>& t2) const
+    { return t1.second > t2.second ||
+          (t1.second == t2.second && t1.first < t2.first); }
+  };
+  std::vector<PBOccurList> pb_occurs; /* constraints of literal */
+  std::vector<guint32> pb_starts;
+  std::vector<guint64> pb_sums;
+  guint32 pb_counted_n;
+  std::vector<guint32> var_count_pos; /* trail position if counted */
+  std::vector<guint32> var_pb; /* constraint implied variable or NO_PB */
+  std::vector<guint32> var_pb_pos; /* pb_counted_n at implication */
+
+  /* add at most constraint of DIMACS literals */
+  void add_card (guint32 lits_n, const gint32* literals, guint32 bound);
+  /* add pseudo-Boolean constraint (size, bound, coefficients and literals) */
+  void add_cnf_pb (const gint64* pb);
+  /* add constraint: sum of weights (any sign) of true literals is at most
+   * bound, clauses and unit implications are added to clauses */
+  void add_pb (LitVector& lits, std::vector<gint64>& weights, gint64 bound);
+  /* replace cliques of binary clauses by at most one constraints */
+  void detect_cards ();
+  void init_pbs ();
+  /* free created reasons of implications by constraints */
+  void free_pb_reasons ();
+  /* temporary clause: first literal (implied or from conflict) if not
+   * LIT_UNDEF and negated true literals counted in prefix of counted_n */
+  ClausePtr pb_clause (guint32 pb, guint32 first, guint32 counted_n);
+  /* summing after assigning literal */
+  Result pb_propagate (guint32 lit);
+  /* reason of variable (creates reason from linear constraint) */
+  ClausePtr reason (guint32 var)
+  {
+    if (var_reasons[var] == CLAUSE_PB)
+      var_reasons[var] = pb_clause (var_pb[var],
+            (var<<1) | ((istrue (var<<1)) ? 0 : 1), var_pb_pos[var]);
+    return var_reasons[var];
+  }
+
   /* max learned clauses before reduction knowledge */
   guint64 max_learned;
+  /* max_learned cannot grow above it after reduce near memory limit */
+  guint64 learned_cap;
+
+  void set_max_learned (guint64 new_max)
+  { max_learned = std::min (new_max, learned_cap); }
+
+  /*
+   * memory accounting: clauses are accounted by current size
+   * (strengthened clauses decrease it), fixed_bytes is variables data.
+   */
+  guint64 clause_bytes;
+  guint64 fixed_bytes;
+  guint64 peak_bytes;
+  /* conflicts number when memory limit can be checked again,
+   * interval is doubled while reduces dont remove memory pressure */
+  guint64 next_memory_check;
+  guint64 memory_check_interval;
+  guint32 memory_reduces_n;
+
+  guint64 used_bytes () const
+  { return fixed_bytes + clause_bytes; }
+  /* if used memory approaches memory budget */
+  bool memory_pressure () const
+  {
+    guint64 limit = get_budget ().memory;
+    return limit != 0 && used_bytes () >= limit - (limit >> 3);
+  }
 
   /* for literals scoring */
   static const double score_inc_factor = 1.0 / 0.95;
@@ -197,73 +421,77 @@ private:
   double cl_score_inc;
   bool after_first_reduce;
 
-  struct Variable
+  /*
+   * variables data split by access: values are checked in BCP,
+   * levels, reasons and used flags only in conflict analysis
+   */
+  /* byte per literal (FLAGS_TRUE or FLAGS_FALSE or zero if unassigned) */
+  guchar* lit_values;
+  guint32* var_levels;
+  ClausePtr* var_reasons;
+  guchar* var_used;
+  guint32* var_sorted; /* position in sorted_varlist */
+  /* for counting distinct levels (glue) of learned clause */
+  guint32* level_stamps;
+  guint32 level_stamp;
+  /* DFS stack of minimize_clause: variable and next literal of its reason */
+  struct MinimizeFrame
   {
-    guint32 flags; /* value and flags */
-    guint32 level; /* assign stack position */
-    guint32 pos_stack;
-    guint32 sorted;
-
-    Variable () : flags (0), level (0), pos_stack (G_MAXUINT32)
+    guint32 var;
+    guint32 next;
+    MinimizeFrame (guint32 invar, guint32 innext) : var (invar), next (innext)
     { }
+  };
+  std::vector<MinimizeFrame> minimize_stack;
+  /* for marking variables visited while shrinking */
+  guint32* var_stamps;
+  guint32 var_stamp;
 
-    /*Variable& operator= (bool v)
-    {
-      flags = (flags & ~FLAGS_VALMASK) | ((v) ? FLAGS_TRUE : FLAGS_FALSE);
-      return *this;
-    }*/
-
-    bool operator== (bool v) const
-    {
-      guint32 tocompare = (v) ? FLAGS_TRUE : FLAGS_FALSE;
-      return ((flags & tocompare) == 0);
-    }
-    bool operator!= (bool v) const
-    {
-      guint32 tocompare = (v) ? FLAGS_TRUE : FLAGS_FALSE;
-      return ((flags & tocompare) == 0);
-    }
-
-    bool get () const
-    { return ((flags & FLAGS_VALMASK) == FLAGS_TRUE); }
+  bool assigned (guint32 var) const
+  { return lit_values[var<<1] != 0; }
 
-    bool assigned () const
-    { return ((flags & FLAGS_VALMASK) != 0); }
-    void unassign ()
-    { flags &= ~FLAGS_VALMASK;
-      pos_stack = G_MAXUINT32; }
+  /* if clause is reason of current assignment of its first literal */
+  bool is_reason (ClausePtr clauseptr) const
+  {
+    guint32 lit = cref (clauseptr)[0];
+    return value (lit) != 0 && var_reasons[lit2var (lit)] == clauseptr;
+  }
 
-    /*Variable& setbylit (gint32 lit)
-    {
-      *this = (lit >= 0);
-      return *this;
-    }
-    bool comparebylit (gint32 lit) const
-    { return (*this == (lit >= 0)); }*/
-    void use ()
-    { flags |= FLAGS_USED; }
-    void unuse ()
-    { flags &= ~FLAGS_USED; }
-    bool is_used () const
-    { return ((flags & FLAGS_USED) != 0); }
+  /*
+   * USED_CLAUSE - variable is in currently learned clause,
+   * USED_POISON - literal can not be removed by minimization
+   */
+  enum {
+    USED_MARK = 1,
+    USED_CLAUSE = 2,
+    USED_POISON = 4
   };
 
-  Variable* varlist;
+  bool is_used (guint32 var) const
+  { return var_used[var] != 0; }
+  bool is_poisoned (guint32 var) const
+  { return var_used[var] == USED_POISON; }
+  void poison (guint32 var)
+  { var_used[var] = USED_POISON; }
+  void use (guint32 var)
+  { var_used[var] = 1; }
+  void unuse (guint32 var)
+  { var_used[var] = 0; }
 
   /* scored variable for VMTF */
   struct ScoredVar
   {
-    gint32 var;
+    guint32 var;
     double score;
 
     ScoredVar () : score (0)
     { }
 
-    void increment (gint32 lit, double inc)
+    void increment (guint32 lit, double inc)
     {
       score += inc;
     }
-    void decrement (gint32 lit, double inc)
+    void decrement (guint32 lit, double inc)
     {
       score -= inc;
     }
@@ -291,73 +519,61 @@ private:
 
   void rescale_vars_scores ();
 
-  bool istrue (gint32 lit)
-  {
-    if (lit >= 0)
-      return ((varlist[lit-1].flags & FLAGS_TRUE) != 0);
-    else
-      return ((varlist[-lit-1].flags & FLAGS_FALSE) != 0);
-  }
-  gint32 value (gint32 lit)
-  {
-    if (lit >= 0)
-      return varlist[lit-1].flags & FLAGS_VALMASK;
-    else
-      return ((varlist[-lit-1].flags >> 1) & FLAGS_TRUE) |
-	((varlist[-lit-1].flags << 1) & FLAGS_FALSE);
-  }
-  void setlit (gint32 lit)
+  bool istrue (guint32 lit) const
+  { return lit_values[lit] == FLAGS_TRUE; }
+  guint32 value (guint32 lit) const
+  { return lit_values[lit]; }
+  void setlit (guint32 lit, ClausePtr reason)
   {
-    guint32 used = (decision_level == 0) ? FLAGS_USED : 0;
-    if (lit >= 0)
-    {
-      Variable& v = varlist[lit-1];
-      /*varlist[lit-1].flags = (varlist[lit-1].flags & ~FLAGS_FALSE) | FLAGS_TRUE;
-      varlist[lit-1].level = decision_level;
-      varlist[lit-1].pos_stack = assign_stack.size ()-1;
-      if (decision_level == 0)
-	varlist[lit-1].use ();*/
-      v.flags = (v.flags & ~FLAGS_FALSE) | FLAGS_TRUE | used;
-      v.level = decision_level;
-      v.pos_stack = assign_stack.size ()-1;
-    }
-    else
-    {
-      Variable& v = varlist[-lit-1];
-      /*varlist[-lit-1].flags = (varlist[-lit-1].flags & ~FLAGS_TRUE) | FLAGS_FALSE;
-      varlist[-lit-1].level = decision_level;
-      varlist[-lit-1].pos_stack = assign_stack.size ()-1;
-      if (decision_level == 0)
-	varlist[-lit-1].use ();*/
-      v.flags = (v.flags & ~FLAGS_TRUE) | FLAGS_FALSE | used;
-      v.level = decision_level;
-      v.pos_stack = assign_stack.size ()-1;
-    }
+    guint32 var = lit2var (lit);
+    lit_values[lit] = FLAGS_TRUE;
+    lit_values[neg (lit)] = FLAGS_FALSE;
+    var_levels[var] = decision_level;
+    var_reasons[var] = reason;
+    if (decision_level == 0)
+      use (var);
   }
-
-  Variable& getvar (gint32 lit)
+  void unsetlit (guint32 lit)
   {
-    return (lit >= 0) ? varlist[lit-1] : varlist[-lit-1];
+    lit_values[lit] = lit_values[neg (lit)] = FLAGS_UNASSIGN;
   }
 
   /* watched list for TWL algorithm */
   typedef std::vector<ClausePtr> WatchedList;
   WatchedList* watched;
 
-  WatchedList& lit2w (gint32 l)
+  WatchedList& lit2w (guint32 l)
   {
-    return (l >= 0) ? watched[l-1] : watched[-l-1 + vars_n];
+    return watched[l];
   }
-  guint32 lit2var (gint32 l)
+
+  /*
+   * occurrence lists of original clauses for level 0 simplification.
+   * satisfied clauses are marked as garbage and removed from lists
+   * and freed lazily; occurs_n counts live clauses with literal.
+   */
+  WatchedList* occurs;
+  guint32* occurs_n;
+  std::vector<guint32> dirty_occurs; /* literals with garbage in occurs */
+  std::vector<bool> occurs_dirty;
+  /* number of level 0 assignments already simplified */
+  guint32 simplified_n;
+  /* variables which can be pure or unused */
+  std::vector<guint32> pure_candidates;
+  /* satisfied original clauses not freed yet */
+  guint32 orig_garbage_n;
+
+  void decrement_occurs (guint32 lit)
   {
-    return std::abs (l)-1;
+    if (--occurs_n[lit] == 0)
+      pure_candidates.push_back (lit2var (lit));
   }
 
   struct Implicate
   {
     ClausePtr clause; /* clause index */
-    gint32 lit; /* literal */
-    Implicate (ClausePtr inclause, gint32 inlit)
+    guint32 lit; /* literal */
+    Implicate (ClausePtr inclause, guint32 inlit)
         : clause (inclause), lit (inlit)
     { }
   };
@@ -365,36 +581,27 @@ private:
   /* implications queue */
   ImplQueue impl_queue;
 
-  struct Assignment
-  {
-    ClausePtr clause; /* clause index */
-    gint32 lit; /* literal */
-    Assignment () { }
-    Assignment (ClausePtr inclause, gint32 inlit)
-	: clause (inclause), lit (inlit)
-    { }
-  };
-
-  typedef std::vector<Assignment> AssignStack;
+  typedef std::vector<guint32> AssignStack;
   typedef AssignStack::iterator AssignStackIter;
   typedef AssignStack::const_iterator AssignStackConstIter;
   /* assignments start position for particular decision levels */
   std::vector<guint32> assign_indices;
-  /* assignment stack */
+  /* assignment stack (trail of assigned literals, reasons are in var_reasons) */
   AssignStack assign_stack;
 
-  void assign (ClausePtr clause, gint32 lit)
+  void assign (ClausePtr clause, guint32 lit)
   {
     //assert (assign_stack.size () < vars_n);
-    assign_stack.push_back (Assignment (clause, lit));
-    setlit (lit);
+    assign_stack.push_back (lit);
+    setlit (lit, clause);
   }
 
   void increment_clause_score (ClausePtr clause)
   {
     ClauseRef ref = cref (clause);
-    ref.score += cl_score_inc;
-    if (ref.score >= cl_score_limit)
+    ref.activity () += cl_score_inc;
+    ref.set_used (true);
+    if (ref.activity () >= cl_score_limit)
       rescale_clauses_score ();
   }
 
@@ -406,26 +613,65 @@ private:
   Result initialize ();
 
   /* make BCP */
-  Result do_propagate (gint32 literal);
+  Result do_propagate (guint32 literal);
   /* backtracking */
   void undo_propagate (guint32 level);
 
   /* derivative implications -> simply generate assertions clause,
    * returns undo decision_level */
-  guint32 derivate_impls (gint32& uip);
+  guint32 derivate_impls (guint32& uip);
 
   /* minimize assert clause: returns good undo decision_level */
-  guint32 minimize_clause (LiteralVector& clause, std::vector<guint32>& used_indices);
+  guint32 minimize_clause (LitVector& clause, std::vector<guint32>& used_indices);
+  bool is_removable (guint32 var, std::vector<guint32>& used_indices);
+  void strengthen_reason (ClausePtr clauseptr);
+  /* shrinking learned clause (all-UIP per level and binary implications) */
+  void shrink_clause (LitVector& clause, std::vector<guint32>& used_indices);
+  guint32 find_level_uip (guint32 level, LitVector::const_iterator begin,
+        LitVector::const_iterator end);
+  void strengthen_by_binaries (LitVector& clause);
+  /* number of distinct decision levels in clause (marks these levels) */
+  guint32 compute_glue (const LitVector& clause);
   /* choose literal */
-  gint32 choose_literal ();
+  guint32 choose_literal ();
 
   /* reduce_learned clause */
   void reduce_learned ();
+  /* release unused capacity of watch lists and clause vectors */
+  void compact_memory ();
+
+  /*
+   * assumptions are decided (in order) before other literals, so learned
+   * clauses do not depend on them. next_assumption is first assumption
+   * that can be not true (reset on backtracking).
+   */
+  LitVector assumptions;
+  std::vector<gint32> assumed_literals; /* DIMACS */
+  guint32 next_assumption;
+  std::vector<gint32> failed_assumptions; /* DIMACS */
+  /* convert assumed literals to assumptions of next solve */
+  void init_assumptions ();
+  /* collect assumptions which imply that literal is false */
+  void analyze_final (guint32 lit);
+
+  /*
+   * incremental solving: next solve continues from level 0 of previous one
+   * (learned clauses and scores are kept). pure literals are not assigned,
+   * because added clauses can contain their negations.
+   */
+  bool incremental;
+  bool initialized; /* first solve is done */
+  bool inconsistent; /* formulae is unsatisfiable without assumptions */
 
   /* simplify formulae after restart */
   Result simplify_formulae ();
+  /* remove original clauses satisfied by level 0 literal */
+  void remove_satisfied (guint32 lit);
+  /* remove garbage from occurrence lists and free satisfied clauses */
+  void purge_satisfied ();
 
   void report_progress (bool newrestart) const;
+  void publish_cdcl_stats ();
 
 public:
   static MySatModule* create ();
@@ -434,6 +680,14 @@ public:
 
   void fetch_problem (const CNF& cnf);
   Result solve (std::vector<bool>& model);
+
+  bool set_incremental ();
+  void add_clause (const LiteralVector& literals);
+
+  void set_assumptions (const std::vector<gint32>& literals)
+  { assumed_literals = literals; }
+  const std::vector<gint32>& get_failed_assumptions () const
+  { return failed_assumptions; }
 };
 
 #endif /* CDCL_H_ */
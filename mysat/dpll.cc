@@ -7,12 +7,15 @@
 #include <assert.h>
 #include <algorithm>
 #include <stack>
+#include <deque>
 #include <glibmm.h>
 #include "dpll.h"
 #include "bcp.h"
 
 DPLLModule::DPLLModule ()
+    : threads_n (1)
 {
+  add_param ("threads", "specify number of search threads", threads_n);
 }
 
 DPLLModule::~DPLLModule ()
@@ -28,6 +31,9 @@ DPLLModule::create ()
 void
 DPLLModule::post_process_params ()
 {
+  if (threads_n == 0)
+    throw ModuleError (ModuleError::BAD_VALUE,
+          "Number of threads must be greater than 0.");
 }
 
 
@@ -42,11 +48,34 @@ void
 DPLLModule::fetch_problem (const CNF& cnf)
 {
   this->cnf = cnf;
+  /* DPLL works only on clauses */
+  if (this->cnf.get_xors_n () != 0)
+    this->cnf.xors_to_clauses ();
+  if (this->cnf.get_cards_n () != 0)
+    this->cnf.cards_to_clauses ();
+  if (this->cnf.get_pbs_n () != 0)
+    this->cnf.pbs_to_clauses ();
+}
+
+void
+DPLLModule::publish_dpll_stats (guint64 decisions, guint64 conflicts,
+      const BoolConstraintPropagate& bcp)
+{
+  SolverStats stats;
+  stats.decisions = decisions;
+  stats.conflicts = conflicts;
+  stats.propagations = bcp.get_propagations_n ();
+  stats.ticks = bcp.get_ticks_n ();
+  stats.trail_size = bcp.get_assigned_n ();
+  publish_stats (stats);
 }
 
 Result
 DPLLModule::solve (std::vector<bool>& model)
 {
+  if (threads_n > 1)
+    return solve_parallel (model);
+
   std::stack<gint32> decision_stack;
   /* variable of literal for current decision */
   guint32 curlit = 0;
@@ -73,6 +102,8 @@ DPLLModule::solve (std::vector<bool>& model)
     decision_stack.push (curlit+1);
 
   guint64 decision_count = 0;
+  guint64 conflict_count = 0;
+  start_budget ();
 
   while (!decision_stack.empty ())
   {
@@ -82,9 +113,17 @@ DPLLModule::solve (std::vector<bool>& model)
 
     if (lit != 0)
     {
+      if (budget_exhausted (conflict_count, bcp.get_propagations_n (),
+            bcp.get_ticks_n ()))
+      {
+        main_result = UNKNOWN;
+        break;
+      }
       Result result = bcp.do_propagate (lit);
 
       ++decision_count;
+      if ((decision_count & 0xff) == 0)
+        publish_dpll_stats (decision_count, conflict_count, bcp);
       if ((decision_count & 0xffff) == 0)
       {
 	std::ostringstream os;
@@ -109,8 +148,12 @@ DPLLModule::solve (std::vector<bool>& model)
 	decision_stack.push (curlit+1);
       }
       /* if unsatisfiable then undo decision when is not last combination */
-      else if (lit > 0)
-        bcp.undo_propagate ();
+      else
+      {
+        conflict_count++;
+        if (lit > 0)
+          bcp.undo_propagate ();
+      }
     }
     else
     {
@@ -136,6 +179,7 @@ DPLLModule::solve (std::vector<bool>& model)
     os << "Decisions: " << decision_count;
     signal_progress_def.emit (os.str ());
   }
+  publish_dpll_stats (decision_count, conflict_count, bcp);
 
   if (main_result == SATISFIABLE)
   {
@@ -146,3 +190,437 @@ DPLLModule::solve (std::vector<bool>& model)
 
   return main_result;
 }
+
+/*
+ * parallel DPLL - search tree is split into subtrees given by decision prefixes.
+ * every worker holds own deque of the prefixes: owner pops from back,
+ * idle workers steal from front (shallowest subtrees).
+ */
+
+typedef std::vector<gint32> DecisionPrefix;
+
+class DPLLModule::WorkQueue
+{
+private:
+  struct Deque
+  {
+    Glib::Threads::Mutex mutex;
+    std::deque<DecisionPrefix> items;
+  };
+
+  DPLLModule& module;
+  guint workers_n;
+  Deque* deques;
+
+  /* for waiting of idle workers */
+  Glib::Threads::Mutex idle_mutex;
+  Glib::Threads::Cond idle_cond;
+
+  /* number of not finished prefixes (queued and in search) */
+  volatile gint pending_n;
+  volatile gint idle_n;
+  volatile gint stopped;
+  volatile gint aborted; /* stopped by budget */
+
+  Glib::Threads::Mutex model_mutex;
+  std::vector<bool> model;
+
+  /* work of all workers, budget is checked for sums */
+  Glib::Threads::Mutex work_mutex;
+  guint64 decisions_n;
+  guint64 conflicts_n;
+  guint64 propagations_n;
+  guint64 ticks_n;
+public:
+  WorkQueue (DPLLModule& inmodule, guint inworkers_n)
+      : module (inmodule), workers_n (inworkers_n), pending_n (0), idle_n (0), stopped (0),
+        aborted (0), decisions_n (0), conflicts_n (0), propagations_n (0), ticks_n (0)
+  { deques = new Deque[workers_n]; }
+  ~WorkQueue ()
+  { delete []deques; }
+
+  bool is_stopped () const
+  { return g_atomic_int_get (&stopped) != 0; }
+  bool is_aborted () const
+  { return g_atomic_int_get (&aborted) != 0; }
+  /* returns true if any worker waits for the work */
+  bool is_hungry () const
+  { return g_atomic_int_get (&idle_n) != 0; }
+  bool own_empty (guint index)
+  {
+    Glib::Threads::Mutex::Lock lock (deques[index].mutex);
+    return deques[index].items.empty ();
+  }
+
+  void push (guint index, const DecisionPrefix& prefix);
+  bool get (guint index, DecisionPrefix& prefix);
+  void finish ();
+  void set_model (const AssignVector& assigns);
+  /* stop all workers without model */
+  void abort ();
+  /* add work done by worker and publish sums as module statistics */
+  void add_work (guint64 decisions, guint64 conflicts, guint64 propagations,
+        guint64 ticks);
+  /* abort search if budget is exhausted by all workers */
+  bool check_budget ();
+  /* set decisions, conflicts, propagations and ticks of all workers */
+  void get_work (SolverStats& stats);
+
+  const std::vector<bool>& get_model () const
+  { return model; }
+};
+
+void
+DPLLModule::WorkQueue::push (guint index, const DecisionPrefix& prefix)
+{
+  g_atomic_int_inc (&pending_n);
+  {
+    Glib::Threads::Mutex::Lock lock (deques[index].mutex);
+    deques[index].items.push_back (prefix);
+  }
+  Glib::Threads::Mutex::Lock lock (idle_mutex);
+  idle_cond.broadcast ();
+}
+
+bool
+DPLLModule::WorkQueue::get (guint index, DecisionPrefix& prefix)
+{
+  bool idle = false;
+  while (!is_stopped ())
+  {
+    bool found = false;
+    { /* own work: deepest subtree */
+      Glib::Threads::Mutex::Lock lock (deques[index].mutex);
+      if (!deques[index].items.empty ())
+      {
+        prefix = deques[index].items.back ();
+        deques[index].items.pop_back ();
+        found = true;
+      }
+    }
+    /* steal from others: shallowest subtree */
+    for (guint i = 1; !found && i < workers_n; i++)
+    {
+      Deque& other = deques[(index + i) % workers_n];
+      Glib::Threads::Mutex::Lock lock (other.mutex);
+      if (!other.items.empty ())
+      {
+        prefix = other.items.front ();
+        other.items.pop_front ();
+        found = true;
+      }
+    }
+    if (found)
+    {
+      if (idle)
+        g_atomic_int_add (&idle_n, -1);
+      return true;
+    }
+
+    if (g_atomic_int_get (&pending_n) == 0)
+      break; /* whole search tree is visited */
+    if (!idle)
+    {
+      g_atomic_int_inc (&idle_n);
+      idle = true;
+    }
+    /* budget is checked also while waiting */
+    if (check_budget ())
+      break;
+    Glib::Threads::Mutex::Lock lock (idle_mutex);
+    idle_cond.wait_until (idle_mutex, g_get_monotonic_time () + 1000);
+  }
+  if (idle)
+    g_atomic_int_add (&idle_n, -1);
+  return false;
+}
+
+void
+DPLLModule::WorkQueue::finish ()
+{
+  if (g_atomic_int_dec_and_test (&pending_n))
+  {
+    Glib::Threads::Mutex::Lock lock (idle_mutex);
+    idle_cond.broadcast ();
+  }
+}
+
+void
+DPLLModule::WorkQueue::set_model (const AssignVector& assigns)
+{
+  Glib::Threads::Mutex::Lock lock (model_mutex);
+  if (!is_stopped ())
+  {
+    model.resize (assigns.size ());
+    for (guint i = 0; i < assigns.size (); i++)
+      model[i] = (assigns[i] == true);
+    g_atomic_int_set (&stopped, 1);
+  }
+}
+
+void
+DPLLModule::WorkQueue::abort ()
+{
+  Glib::Threads::Mutex::Lock lock (model_mutex);
+  if (!is_stopped ())
+  {
+    g_atomic_int_set (&aborted, 1);
+    g_atomic_int_set (&stopped, 1);
+  }
+}
+
+void
+DPLLModule::WorkQueue::add_work (guint64 decisions, guint64 conflicts,
+      guint64 propagations, guint64 ticks)
+{
+  SolverStats stats;
+  {
+    Glib::Threads::Mutex::Lock lock (work_mutex);
+    decisions_n += decisions;
+    conflicts_n += conflicts;
+    propagations_n += propagations;
+    ticks_n += ticks;
+  }
+  get_work (stats);
+  module.publish_stats (stats);
+}
+
+bool
+DPLLModule::WorkQueue::check_budget ()
+{
+  bool exhausted;
+  {
+    Glib::Threads::Mutex::Lock lock (work_mutex);
+    exhausted = module.budget_exhausted (conflicts_n, propagations_n, ticks_n);
+  }
+  if (exhausted)
+    abort ();
+  return exhausted;
+}
+
+void
+DPLLModule::WorkQueue::get_work (SolverStats& stats)
+{
+  Glib::Threads::Mutex::Lock lock (work_mutex);
+  stats.decisions = decisions_n;
+  stats.conflicts = conflicts_n;
+  stats.propagations = propagations_n;
+  stats.ticks = ticks_n;
+}
+
+class DPLLModule::Worker
+{
+private:
+  struct Decision
+  {
+    gint32 lit;
+    bool last; /* if no alternative to try */
+    Decision (gint32 inlit) : lit (inlit), last (false)
+    { }
+  };
+
+  DPLLModule& module;
+  WorkQueue& queue;
+  guint index;
+  /* own copy of clauses, because BCP reorders literals in clauses */
+  CNF cnf;
+  AssignVector assigns;
+  BoolConstraintPropagate bcp;
+  guint base_level;
+  Result initial_result;
+
+  DecisionPrefix prefix;
+  std::vector<Decision> stack;
+  guint64 decision_count;
+  guint64 conflict_count;
+  /* work already added to queue */
+  guint64 added_decisions;
+  guint64 added_conflicts;
+  guint64 added_propagations;
+  guint64 added_ticks;
+
+  bool search ();
+  void split ();
+  void add_work ();
+public:
+  Worker (DPLLModule& inmodule, WorkQueue& inqueue, guint inindex);
+
+  Result get_initial_result () const
+  { return initial_result; }
+  guint64 get_decision_count () const
+  { return decision_count; }
+
+  void run ();
+};
+
+DPLLModule::Worker::Worker (DPLLModule& inmodule, WorkQueue& inqueue, guint inindex)
+    : module (inmodule), queue (inqueue), index (inindex), cnf (inmodule.cnf),
+      assigns (cnf.get_vars_n ()), bcp (cnf, assigns), decision_count (0),
+      conflict_count (0), added_decisions (0), added_conflicts (0), added_propagations (0),
+      added_ticks (0)
+{
+  initial_result = SATISFIABLE;
+  if (bcp.is_before_unsatisfiable ())
+    initial_result = UNSATISFIABLE;
+  else if (!bcp.empty_queue () && bcp.do_propagate (0) == UNSATISFIABLE)
+    initial_result = UNSATISFIABLE;
+  base_level = bcp.get_level ();
+}
+
+void
+DPLLModule::Worker::add_work ()
+{
+  queue.add_work (decision_count - added_decisions,
+        conflict_count - added_conflicts,
+        bcp.get_propagations_n () - added_propagations,
+        bcp.get_ticks_n () - added_ticks);
+  added_decisions = decision_count;
+  added_conflicts = conflict_count;
+  added_propagations = bcp.get_propagations_n ();
+  added_ticks = bcp.get_ticks_n ();
+}
+
+/* move shallowest untried alternative to own deque */
+void
+DPLLModule::Worker::split ()
+{
+  guint i;
+  for (i = 0; i < stack.size () && stack[i].last; i++);
+  if (i == stack.size ())
+    return;
+
+  DecisionPrefix newprefix (prefix);
+  for (guint j = 0; j < i; j++)
+    newprefix.push_back (stack[j].lit);
+  newprefix.push_back (-stack[i].lit);
+  stack[i].last = true;
+  queue.push (index, newprefix);
+}
+
+/* search in subtree given by prefix, returns true if model found */
+bool
+DPLLModule::Worker::search ()
+{
+  if (bcp.get_level () > base_level)
+    bcp.undo_propagate (bcp.get_level () - base_level);
+
+  for (DecisionPrefix::const_iterator it = prefix.begin (); it != prefix.end (); ++it)
+  {
+    if (assigns[lit2var (*it)].assigned ())
+    {
+      if (!assigns.get (*it))
+        return false;
+    }
+    else if (bcp.do_propagate (*it) == UNSATISFIABLE)
+      return false;
+  }
+
+  stack.clear ();
+  gint32 lit = 0;
+  while (!queue.is_stopped ())
+  {
+    if (lit == 0)
+    {
+      if (bcp.get_assigned_n () == cnf.get_vars_n ())
+        return true;
+      guint32 var = module.choose_variable (assigns,
+            (stack.empty ()) ? 0 : lit2var (stack.back ().lit));
+      lit = var+1;
+      stack.push_back (Decision (lit));
+    }
+
+    if (queue.is_hungry () && queue.own_empty (index))
+      split ();
+
+    if ((decision_count & 0xff) == 0)
+    {
+      add_work ();
+      if (queue.check_budget ())
+        return false;
+    }
+    ++decision_count;
+    if (bcp.do_propagate (lit) == SATISFIABLE)
+    {
+      lit = 0;
+      continue;
+    }
+    conflict_count++;
+    bcp.undo_propagate ();
+
+    /* backtrack to deepest decision with alternative */
+    while (stack.back ().last)
+    {
+      stack.pop_back ();
+      if (stack.empty ())
+        return false;
+      bcp.undo_propagate ();
+    }
+    stack.back ().lit = -stack.back ().lit;
+    stack.back ().last = true;
+    lit = stack.back ().lit;
+  }
+  return false;
+}
+
+void
+DPLLModule::Worker::run ()
+{
+  while (queue.get (index, prefix))
+  {
+    if (search ())
+      queue.set_model (assigns);
+    queue.finish ();
+  }
+  add_work ();
+}
+
+Result
+DPLLModule::solve_parallel (std::vector<bool>& model)
+{
+  WorkQueue queue (*this, threads_n);
+  std::vector<Worker*> workers (threads_n);
+  std::vector<Glib::Threads::Thread*> threads;
+
+  for (guint i = 0; i < threads_n; i++)
+    workers[i] = new Worker (*this, queue, i);
+
+  start_budget ();
+  Result main_result = workers[0]->get_initial_result ();
+  if (main_result != UNSATISFIABLE)
+  {
+    queue.push (0, DecisionPrefix ());
+    for (guint i = 1; i < threads_n; i++)
+      threads.push_back (Glib::Threads::Thread::create (
+            sigc::mem_fun (*workers[i], &Worker::run)));
+    workers[0]->run ();
+    for (guint i = 0; i < threads.size (); i++)
+      threads[i]->join ();
+
+    if (queue.is_aborted ())
+      main_result = UNKNOWN;
+    else
+      main_result = (queue.is_stopped ()) ? SATISFIABLE : UNSATISFIABLE;
+  }
+
+  guint64 decision_count = 0;
+  for (guint i = 0; i < threads_n; i++)
+  {
+    decision_count += workers[i]->get_decision_count ();
+    delete workers[i];
+  }
+
+  {
+    std::ostringstream os;
+    os << "Decisions: " << decision_count << ", threads: " << threads_n;
+    signal_progress_def.emit (os.str ());
+  }
+  {
+    SolverStats stats;
+    queue.get_work (stats);
+    publish_stats (stats);
+  }
+
+  if (main_result == SATISFIABLE)
+    model = queue.get_model ();
+  return main_result;
+}
@@ -10,15 +10,26 @@
 #include <glibmm.h>
 #include "module.h"
 
+class BoolConstraintPropagate;
+
 class DPLLModule: public MySatModule
 {
 private:
   CNF cnf;
+  guint threads_n;
+
+  /* parallel search: work queue with stealing and single search thread */
+  class WorkQueue;
+  class Worker;
 
   DPLLModule ();
   void post_process_params ();
 
   guint32 choose_variable(const AssignVector& assigns, guint32 curlit);
+  void publish_dpll_stats (guint64 decisions, guint64 conflicts,
+        const BoolConstraintPropagate& bcp);
+
+  Result solve_parallel (std::vector<bool>& model);
 public:
   static MySatModule* create ();
 
@@ -0,0 +1,232 @@
+/*
+ * ipasir.cc - IPASIR interface of mysat solver
+ * Author: Mateusz Szpakowski
+ * License: LGPL v2.0
+ */
+
+#include <algorithm>
+#include <exception>
+#include <glibmm.h>
+#include <satutils.h>
+#include "cdcl.h"
+#include "ipasir.h"
+
+using namespace SatUtils;
+
+namespace
+{
+
+/*
+ * solver instance holds one incremental CDCL module, so learned clauses
+ * are kept between solves. module has spare variables, added clauses are
+ * kept also in CNF to create module again if new variables are used up.
+ */
+class IpasirSolver
+{
+private:
+  CNF cnf;
+  CDCLModule* module;
+  gint32 module_vars_n;
+  LiteralVector clause;
+  std::vector<gint32> assumptions;
+  std::vector<bool> model;
+  std::vector<gint32> failed; /* sorted */
+  void* terminate_state;
+  int (*terminate) (void* state);
+
+  void add_var (gint32 lit)
+  {
+    guint32 var = std::abs (lit);
+    if (var > cnf.get_vars_n ())
+      cnf.add_vars (var - cnf.get_vars_n ());
+  }
+  void release_module ()
+  {
+    delete module;
+    module = NULL;
+  }
+  void create_module ();
+public:
+  IpasirSolver () : module (NULL), module_vars_n (0), terminate_state (NULL),
+      terminate (NULL)
+  { }
+  ~IpasirSolver ()
+  { release_module (); }
+
+  void add (gint32 lit);
+  void assume (gint32 lit)
+  {
+    add_var (lit);
+    assumptions.push_back (lit);
+  }
+  int solve ();
+  int val (gint32 lit) const;
+  bool is_failed (gint32 lit) const
+  { return std::binary_search (failed.begin (), failed.end (), lit); }
+  void set_terminate (void* state, int (*callback) (void* state))
+  {
+    terminate_state = state;
+    terminate = callback;
+  }
+};
+
+void
+IpasirSolver::add (gint32 lit)
+{
+  if (lit != 0)
+  {
+    add_var (lit);
+    clause.push_back (lit);
+    return;
+  }
+  if (clause.empty ())
+    add_var (1); /* empty clause needs variable */
+  cnf.add_clause (clause);
+  if (module != NULL && cnf.get_vars_n () <= module_vars_n)
+  {
+    try
+    {
+      module->add_clause (clause);
+    }
+    catch (const Glib::Exception&)
+    {
+      release_module ();
+    }
+  }
+  else /* created again by next solve */
+    release_module ();
+  clause.clear ();
+}
+
+void
+IpasirSolver::create_module ()
+{
+  /* minimal number of free variables of new module */
+  static const gint32 min_spare_vars_n = 256;
+
+  release_module ();
+  CNF module_cnf (cnf);
+  module_cnf.normalize_clauses ();
+  module_cnf.add_vars (std::max (min_spare_vars_n, cnf.get_vars_n () / 2));
+  module = static_cast<CDCLModule*>(CDCLModule::create ());
+  module->set_incremental ();
+  module->fetch_problem (module_cnf);
+  module_vars_n = module_cnf.get_vars_n ();
+}
+
+int
+IpasirSolver::solve ()
+{
+  model.clear ();
+  failed.clear ();
+  Result result = UNKNOWN;
+  try
+  {
+    if (module == NULL || cnf.get_vars_n () > module_vars_n)
+      create_module ();
+    module->set_assumptions (assumptions);
+    if (terminate != NULL)
+      module->set_terminate (sigc::bind (sigc::ptr_fun (terminate),
+            terminate_state));
+    else
+      module->set_terminate (sigc::slot<bool> ());
+    result = module->solve (model);
+    /* spare variables are not in model */
+    if (result == SATISFIABLE)
+      model.resize (cnf.get_vars_n ());
+    else if (result == UNSATISFIABLE)
+    {
+      failed = module->get_failed_assumptions ();
+      std::sort (failed.begin (), failed.end ());
+    }
+  }
+  catch (const Glib::Exception&)
+  {
+    result = UNKNOWN;
+    release_module ();
+  }
+  catch (const std::exception&)
+  {
+    result = UNKNOWN;
+    release_module ();
+  }
+  assumptions.clear ();
+
+  if (result == SATISFIABLE)
+    return 10;
+  else if (result == UNSATISFIABLE)
+    return 20;
+  return 0;
+}
+
+int
+IpasirSolver::val (gint32 lit) const
+{
+  guint32 var = std::abs (lit);
+  if (var == 0 || var > model.size ())
+    return 0;
+  return (model[var-1] == (lit > 0)) ? lit : -lit;
+}
+
+};
+
+const char*
+ipasir_signature (void)
+{
+  return "mysat-" MYSAT_VERSION;
+}
+
+void*
+ipasir_init (void)
+{
+  return new IpasirSolver ();
+}
+
+void
+ipasir_release (void* solver)
+{
+  delete static_cast<IpasirSolver*>(solver);
+}
+
+void
+ipasir_add (void* solver, int lit_or_zero)
+{
+  static_cast<IpasirSolver*>(solver)->add (lit_or_zero);
+}
+
+void
+ipasir_assume (void* solver, int lit)
+{
+  static_cast<IpasirSolver*>(solver)->assume (lit);
+}
+
+int
+ipasir_solve (void* solver)
+{
+  return static_cast<IpasirSolver*>(solver)->solve ();
+}
+
+int
+ipasir_val (void* solver, int lit)
+{
+  return static_cast<IpasirSolver*>(solver)->val (lit);
+}
+
+int
+ipasir_failed (void* solver, int lit)
+{
+  return (static_cast<IpasirSolver*>(solver)->is_failed (lit)) ? 1 : 0;
+}
+
+void
+ipasir_set_terminate (void* solver, void* state,
+      int (*terminate) (void* state))
+{
+  static_cast<IpasirSolver*>(solver)->set_terminate (state, terminate);
+}
+
+void
+ipasir_set_learn (void* solver, void* state, int max_length,
+      void (*learn) (void* state, int* clause))
+{
+}
@@ -0,0 +1,46 @@
+/*
+ * ipasir.h - IPASIR interface of mysat solver
+ * Author: Mateusz Szpakowski
+ * License: LGPL v2.0
+ */
+
+#ifndef __MYSAT_IPASIR_H__
+#define __MYSAT_IPASIR_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * every solver instance is independent, so instances can be used
+ * in many threads (one thread per instance at same time).
+ */
+
+/* name and version of solver */
+const char* ipasir_signature (void);
+/* create new solver instance */
+void* ipasir_init (void);
+/* destroy solver instance */
+void ipasir_release (void* solver);
+/* add literal of clause, zero terminates clause */
+void ipasir_add (void* solver, int lit_or_zero);
+/* assume literal in next solve (assumptions are cleared after solve) */
+void ipasir_assume (void* solver, int lit);
+/* returns 10 if satisfiable, 20 if unsatisfiable, 0 if interrupted */
+int ipasir_solve (void* solver);
+/* value of literal in model: lit if true, -lit if false, 0 if unknown */
+int ipasir_val (void* solver, int lit);
+/* returns 1 if assumption was used to prove unsatisfiability */
+int ipasir_failed (void* solver, int lit);
+/* solving is stopped when terminate returns nonzero value */
+void ipasir_set_terminate (void* solver, void* state,
+      int (*terminate) (void* state));
+/* learned clauses are not exported (callback is never called) */
+void ipasir_set_learn (void* solver, void* state, int max_length,
+      void (*learn) (void* state, int* clause));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MYSAT_IPASIR_H__ */
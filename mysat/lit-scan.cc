@@ -0,0 +1,148 @@
+/*
+ * lit-scan.cc - vectorized search of not false literal in clause
+ * Author: Mateusz Szpakowski
+ * License: LGPL v2.0
+ */
+
+#include <glibmm.h>
+#include "mysat-types.h"
+#include "lit-scan.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LIT_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+guint32
+lit_scan_scalar (const gint32* lits, guint32 n, const guchar* values, guint32 shift)
+{
+  for (guint32 i = 0; i < n; i++)
+  {
+    gint32 sign = lits[i] >> 31;
+    guint32 var = ((lits[i] ^ sign) - sign) - 1;
+    /* positive literal is false if value is false, negative if value is true */
+    if ((values[var << shift] & (ASSIGN_FALSE >> (sign & 1))) == 0)
+      return i;
+  }
+  return n;
+}
+
+guint32
+litval_scan_scalar (const guint32* lits, guint32 n, const guchar* litvalues)
+{
+  for (guint32 i = 0; i < n; i++)
+    if ((litvalues[lits[i]] & ASSIGN_FALSE) == 0)
+      return i;
+  return n;
+}
+
+#ifdef LIT_SCAN_X86
+/* indices are computed in vector, values are loaded by scalar loads */
+__attribute__((target("sse2")))
+static guint32
+lit_scan_sse2 (const gint32* lits, guint32 n, const guchar* values, guint32 shift)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  const __m128i one = _mm_set1_epi32 (1);
+  const __m128i two = _mm_set1_epi32 (ASSIGN_FALSE);
+  const __m128i vshift = _mm_cvtsi32_si128 (shift);
+  guint32 i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    __m128i l = _mm_loadu_si128 (reinterpret_cast<const __m128i*>(lits + i));
+    __m128i sign = _mm_srai_epi32 (l, 31);
+    __m128i var = _mm_sub_epi32 (_mm_sub_epi32 (_mm_xor_si128 (l, sign), sign), one);
+    var = _mm_sll_epi32 (var, vshift);
+
+    guint32 offsets[4] __attribute__((aligned(16)));
+    _mm_store_si128 (reinterpret_cast<__m128i*>(offsets), var);
+    __m128i vals = _mm_set_epi32 (values[offsets[3]], values[offsets[2]],
+          values[offsets[1]], values[offsets[0]]);
+
+    /* mask: 2 (false) for positive literals, 1 (true) for negative */
+    __m128i mask = _mm_add_epi32 (two, sign);
+    __m128i notfalse = _mm_cmpeq_epi32 (_mm_and_si128 (vals, mask), zero);
+    int m = _mm_movemask_ps (_mm_castsi128_ps (notfalse));
+    if (m != 0)
+      return i + __builtin_ctz (m);
+  }
+  return i + lit_scan_scalar (lits + i, n - i, values, shift);
+}
+
+__attribute__((target("avx2")))
+static guint32
+lit_scan_avx2 (const gint32* lits, guint32 n, const guchar* values, guint32 shift)
+{
+  const __m256i zero = _mm256_setzero_si256 ();
+  const __m256i one = _mm256_set1_epi32 (1);
+  const __m256i two = _mm256_set1_epi32 (ASSIGN_FALSE);
+  const __m256i bytemask = _mm256_set1_epi32 (0xff);
+  const __m128i vshift = _mm_cvtsi32_si128 (shift);
+  guint32 i = 0;
+  for (; i + 8 <= n; i += 8)
+  {
+    __m256i l = _mm256_loadu_si256 (reinterpret_cast<const __m256i*>(lits + i));
+    __m256i sign = _mm256_srai_epi32 (l, 31);
+    __m256i var = _mm256_sub_epi32 (_mm256_abs_epi32 (l), one);
+    var = _mm256_sll_epi32 (var, vshift);
+    /* gather dwords at byte offsets, only lowest byte is used */
+    __m256i vals = _mm256_and_si256 (bytemask, _mm256_i32gather_epi32 (
+          reinterpret_cast<const int*>(values), var, 1));
+
+    __m256i mask = _mm256_add_epi32 (two, sign);
+    __m256i notfalse = _mm256_cmpeq_epi32 (_mm256_and_si256 (vals, mask), zero);
+    int m = _mm256_movemask_ps (_mm256_castsi256_ps (notfalse));
+    if (m != 0)
+      return i + __builtin_ctz (m);
+  }
+  return i + lit_scan_sse2 (lits + i, n - i, values, shift);
+}
+
+__attribute__((target("avx2")))
+static guint32
+litval_scan_avx2 (const guint32* lits, guint32 n, const guchar* litvalues)
+{
+  const __m256i zero = _mm256_setzero_si256 ();
+  const __m256i falsebit = _mm256_set1_epi32 (ASSIGN_FALSE);
+  guint32 i = 0;
+  for (; i + 8 <= n; i += 8)
+  {
+    __m256i l = _mm256_loadu_si256 (reinterpret_cast<const __m256i*>(lits + i));
+    /* gather dwords at byte offsets, only lowest byte is used */
+    __m256i vals = _mm256_i32gather_epi32 (
+          reinterpret_cast<const int*>(litvalues), l, 1);
+    __m256i notfalse = _mm256_cmpeq_epi32 (_mm256_and_si256 (vals, falsebit), zero);
+    int m = _mm256_movemask_ps (_mm256_castsi256_ps (notfalse));
+    if (m != 0)
+      return i + __builtin_ctz (m);
+  }
+  return i + litval_scan_scalar (lits + i, n - i, litvalues);
+}
+#endif
+
+static LitValScanFunc
+litval_scan_select ()
+{
+#ifdef LIT_SCAN_X86
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("avx2"))
+    return litval_scan_avx2;
+#endif
+  return litval_scan_scalar;
+}
+
+static LitScanFunc
+lit_scan_select ()
+{
+#ifdef LIT_SCAN_X86
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("avx2"))
+    return lit_scan_avx2;
+  if (__builtin_cpu_supports ("sse2"))
+    return lit_scan_sse2;
+#endif
+  return lit_scan_scalar;
+}
+
+const LitScanFunc lit_scan = lit_scan_select ();
+const LitValScanFunc litval_scan = litval_scan_select ();
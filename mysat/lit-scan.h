@@ -0,0 +1,43 @@
+/*
+ * lit-scan.h - vectorized search of not false literal in clause
+ * Author: Mateusz Szpakowski
+ * License: LGPL v2.0
+ */
+
+#ifndef __MYSAT_LIT_SCAN_H__
+#define __MYSAT_LIT_SCAN_H__
+
+#include <glibmm.h>
+
+/*
+ * finding replacement of the watch in long clauses.
+ * values - byte with value of variable v is at values[v << shift], and it holds
+ *   ASSIGN_TRUE/ASSIGN_FALSE (FLAGS_TRUE/FLAGS_FALSE) in two lowest bits.
+ * returns index of first literal which is not false or n if all literals are false.
+ * vectorized versions can load 3 bytes beyond value of last variable.
+ */
+typedef guint32 (*LitScanFunc) (const gint32* lits, guint32 n,
+      const guchar* values, guint32 shift);
+
+/* minimal number of scanned literals for which vectorized scan is used */
+static const guint32 lit_scan_min_size = 16;
+
+/* selected at startup by CPU features (AVX2, SSE2 or scalar) */
+extern const LitScanFunc lit_scan;
+
+guint32 lit_scan_scalar (const gint32* lits, guint32 n,
+      const guchar* values, guint32 shift);
+
+/*
+ * same search for values indexed directly by literal:
+ * literal l (unsigned 2*var+sign encoding) is false if litvalues[l]
+ * has ASSIGN_FALSE bit.
+ */
+typedef guint32 (*LitValScanFunc) (const guint32* lits, guint32 n,
+      const guchar* litvalues);
+
+extern const LitValScanFunc litval_scan;
+
+guint32 litval_scan_scalar (const guint32* lits, guint32 n, const guchar* litvalues);
+
+#endif /* __MYSAT_LIT_SCAN_H__ */
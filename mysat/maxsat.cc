@@ -0,0 +1,317 @@
+/*
+ * maxsat.cc - core-guided MaxSAT solving
+ * Author: Mateusz Szpakowski
+ * License: LGPL v2.0
+ */
+
+#include <algorithm>
+#include <sstream>
+#include <glibmm.h>
+#include "maxsat.h"
+
+namespace
+{
+
+/* number of new variables of totalizer (inputs are not counted) */
+gint32
+totalizer_vars_n (gint32 inputs_n)
+{
+  if (inputs_n <= 1)
+    return 0;
+  return inputs_n + totalizer_vars_n (inputs_n / 2) +
+      totalizer_vars_n (inputs_n - inputs_n / 2);
+}
+
+};
+
+MaxSatSolver::MaxSatSolver (MySatModuleCreateCallback create_callback,
+      const std::string& params)
+    : create (create_callback), module_params (params), current (0),
+      interrupted (0), stop_reason (0), solver_vars_n (0)
+{
+}
+
+void
+MaxSatSolver::interrupt ()
+{
+  g_atomic_int_set (&interrupted, 1);
+  MySatModule* module = current;
+  if (module != 0)
+    module->interrupt ();
+}
+
+void
+MaxSatSolver::reserve_vars (gint32 vars_n)
+{
+  /* minimal number of free variables of new solver */
+  static const gint32 min_spare_vars_n = 1024;
+
+  if (solver.get () != 0 && hard.get_vars_n () + vars_n <= solver_vars_n)
+    return;
+
+  /* learned clauses of old solver are lost */
+  current = 0;
+  solver.reset ();
+  CNF solver_cnf (hard);
+  solver_cnf.add_vars (std::max (min_spare_vars_n,
+        vars_n + hard.get_vars_n () / 2));
+
+  std::auto_ptr<MySatModule> new_solver (create ());
+  if (!new_solver->set_incremental ())
+    throw ModuleError (ModuleError::OTHER_ERROR,
+          "Module doesnt support incremental solving");
+  if (module_params.size () != 0)
+    new_solver->parse_params (module_params);
+  new_solver->fetch_problem (solver_cnf);
+  solver = new_solver;
+  solver_vars_n = solver_cnf.get_vars_n ();
+  current = solver.get ();
+}
+
+void
+MaxSatSolver::add_hard_clause (const LiteralVector& literals)
+{
+  LiteralVector clause (literals);
+  std::sort (clause.begin (), clause.end ());
+  clause.erase (std::unique (clause.begin (), clause.end ()), clause.end ());
+  hard.add_clause (clause);
+  solver->add_clause (clause);
+}
+
+LiteralVector
+MaxSatSolver::build_totalizer (LiteralConstIter begin, LiteralConstIter end)
+{
+  if (end - begin == 1)
+    return LiteralVector (begin, end);
+  LiteralConstIter middle = begin + (end - begin) / 2;
+  const LiteralVector left = build_totalizer (begin, middle);
+  const LiteralVector right = build_totalizer (middle, end);
+
+  LiteralVector outputs;
+  for (guint32 i = 0; i < left.size () + right.size (); i++)
+    outputs.push_back (hard.add_var ());
+  /* i true left inputs and j true right inputs imply i+j true inputs */
+  LiteralVector clause;
+  for (guint32 i = 0; i <= left.size (); i++)
+    for (guint32 j = 0; j <= right.size (); j++)
+      if (i + j != 0)
+      {
+        clause.clear ();
+        if (i != 0)
+          clause.push_back (-left[i-1]);
+        if (j != 0)
+          clause.push_back (-right[j-1]);
+        clause.push_back (outputs[i+j-1]);
+        add_hard_clause (clause);
+      }
+  return outputs;
+}
+
+void
+MaxSatSolver::relax_core (const std::vector<gint32>& core, guint64 min_weight)
+{
+  for (std::vector<gint32>::const_iterator lit = core.begin ();
+       lit != core.end (); ++lit)
+  {
+    std::map<gint32, guint64>::iterator it = weights.find (*lit);
+    it->second -= min_weight;
+    if (it->second == 0)
+      weights.erase (it);
+
+    /* sum of totalizer can be greater: assume next bound */
+    std::map<gint32, std::pair<guint32, guint32> >::const_iterator sum =
+        sum_outputs.find (*lit);
+    if (sum != sum_outputs.end ())
+    {
+      const LiteralVector& outputs = totalizers[sum->second.first];
+      const guint32 bound = sum->second.second;
+      if (bound < outputs.size ())
+      {
+        weights[-outputs[bound]] += min_weight;
+        sum_outputs[-outputs[bound]] = std::make_pair (sum->second.first,
+              bound + 1);
+      }
+    }
+  }
+
+  if (core.size () == 1)
+  {
+    /* assumption is always false */
+    add_hard_clause (LiteralVector (1, -core[0]));
+    return;
+  }
+  /* at least one assumption of core is false, assume that only one */
+  LiteralVector inputs;
+  for (std::vector<gint32>::const_iterator lit = core.begin ();
+       lit != core.end (); ++lit)
+    inputs.push_back (-*lit);
+  reserve_vars (totalizer_vars_n (inputs.size ()));
+  totalizers.push_back (build_totalizer (inputs.begin (), inputs.end ()));
+  const gint32 bound_lit = -totalizers.back ()[1];
+  weights[bound_lit] += min_weight;
+  sum_outputs[bound_lit] = std::make_pair (guint32 (totalizers.size () - 1),
+        guint32 (2));
+}
+
+Result
+MaxSatSolver::solve_assumptions (const std::vector<gint32>& assumptions,
+      std::vector<bool>& model)
+{
+  if (g_atomic_int_get (&interrupted))
+  {
+    stop_reason = "interrupted";
+    return UNKNOWN;
+  }
+  /* time limits whole solving, other limits every solve */
+  SolverBudget solve_budget = budget;
+  if (budget.time != 0)
+  {
+    solve_budget.time = budget.time - timer.elapsed ();
+    if (solve_budget.time <= 0.0)
+    {
+      stop_reason = "time";
+      return UNKNOWN;
+    }
+  }
+  solver->set_budget (solve_budget);
+  solver->set_assumptions (assumptions);
+  Result result = solver->solve (model);
+  if (result == UNKNOWN)
+    stop_reason = solver->get_stop_reason ();
+  return result;
+}
+
+Result
+MaxSatSolver::solve (const CNF& cnf,
+      const sigc::slot<void, guint64>& bound_slot,
+      std::vector<bool>& best_model, guint64& best_cost)
+{
+  stop_reason = 0;
+  g_atomic_int_set (&interrupted, 0);
+  timer.start ();
+  weights.clear ();
+  totalizers.clear ();
+  sum_outputs.clear ();
+  current = 0;
+  solver.reset ();
+  best_model.clear ();
+  best_cost = G_MAXUINT64;
+
+  /* soft clause is satisfied if its assumption is true */
+  hard = cnf;
+  guint64 lower = 0;
+  LiteralVector clause;
+  LiteralConstIter literal = cnf.get_softs ().begin ();
+  for (guint32 i = 0; i < cnf.get_softs_n (); i++)
+  {
+    gint32 literals_n = *literal++;
+    clause.assign (literal, literal + literals_n);
+    literal += literals_n;
+    const guint64 weight = cnf.get_soft_weights ()[i];
+    std::sort (clause.begin (), clause.end ());
+    clause.erase (std::unique (clause.begin (), clause.end ()), clause.end ());
+
+    bool tautology = false;
+    for (LiteralConstIter it = clause.begin (); it != clause.end (); ++it)
+      if (std::binary_search (clause.begin (), clause.end (), -*it))
+        tautology = true;
+    if (weight == 0 || tautology)
+      continue;
+    if (clause.empty ())
+      lower += weight;
+    else if (clause.size () == 1 &&
+        weights.find (-clause[0]) == weights.end ())
+      weights[clause[0]] += weight;
+    else
+    {
+      /* relaxation variable is true if clause is not satisfied */
+      const gint32 relax = hard.add_var ();
+      clause.push_back (relax);
+      hard.add_clause (clause);
+      weights[-relax] += weight;
+    }
+  }
+  hard.normalize_clauses ();
+  reserve_vars (0);
+
+  guint64 stratum = 0;
+  for (std::map<gint32, guint64>::const_iterator it = weights.begin ();
+       it != weights.end (); ++it)
+    stratum = std::max (stratum, it->second);
+
+  Result final_result = UNKNOWN;
+  std::vector<gint32> assumptions;
+  std::vector<gint32> core;
+  std::vector<bool> model;
+  while (true)
+  {
+    assumptions.clear ();
+    for (std::map<gint32, guint64>::const_iterator it = weights.begin ();
+         it != weights.end (); ++it)
+      if (it->second >= stratum)
+        assumptions.push_back (it->first);
+
+    Result result = solve_assumptions (assumptions, model);
+    if (result == UNKNOWN)
+      break;
+    if (result == SATISFIABLE)
+    {
+      model.resize (cnf.get_vars_n ());
+      const guint64 cost = cnf.evaluate_cost (model);
+      if (cost < best_cost)
+      {
+        best_cost = cost;
+        best_model = model;
+        bound_slot (cost);
+      }
+      /* next stratum: greatest weight less than current */
+      guint64 next_stratum = 0;
+      for (std::map<gint32, guint64>::const_iterator it = weights.begin ();
+           it != weights.end (); ++it)
+        if (it->second < stratum)
+          next_stratum = std::max (next_stratum, it->second);
+      if (next_stratum == 0 || best_cost == lower)
+      {
+        final_result = SATISFIABLE;
+        break;
+      }
+      stratum = next_stratum;
+      continue;
+    }
+
+    const std::vector<gint32>& failed = solver->get_failed_assumptions ();
+    core.clear ();
+    for (std::vector<gint32>::const_iterator lit = failed.begin ();
+         lit != failed.end (); ++lit)
+      if (weights.find (*lit) != weights.end ())
+        core.push_back (*lit);
+    std::sort (core.begin (), core.end ());
+    core.erase (std::unique (core.begin (), core.end ()), core.end ());
+    if (core.empty ())
+    {
+      /* hard clauses are unsatisfiable */
+      final_result = UNSATISFIABLE;
+      break;
+    }
+    guint64 min_weight = G_MAXUINT64;
+    for (std::vector<gint32>::const_iterator lit = core.begin ();
+         lit != core.end (); ++lit)
+      min_weight = std::min (min_weight, weights[*lit]);
+    lower += min_weight;
+    {
+      std::ostringstream os;
+      os << "Lower bound: " << lower << ", core size: " << core.size ();
+      signal_progress_def.emit (os.str ());
+    }
+    if (lower >= best_cost)
+    {
+      final_result = SATISFIABLE;
+      break;
+    }
+    relax_core (core, min_weight);
+  }
+
+  current = 0;
+  solver.reset ();
+  return final_result;
+}
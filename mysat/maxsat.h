@@ -0,0 +1,87 @@
+/*
+ * maxsat.h - core-guided MaxSAT solving
+ * Author: Mateusz Szpakowski
+ * License: LGPL v2.0
+ */
+
+#ifndef __MYSAT_MAXSAT_H__
+#define __MYSAT_MAXSAT_H__
+
+#include <glibmm.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <satutils.h>
+#include "modules-table.h"
+
+/*
+ * MaxSatSolver - finds model of hard clauses with minimal cost of
+ * not satisfied soft clauses by OLL algorithm. soft clauses are assumed
+ * to be satisfied, every unsatisfiable core increases lower bound and
+ * its literals are relaxed by totalizer (at least one of them is false).
+ * weights are split between cores and solved in strata (greatest first).
+ *
+ * all cores are found by one incremental solver (created by callback).
+ * variables of totalizers are reserved before solving, solver is created
+ * again (with hard clauses and totalizers) only if they are used up.
+ */
+class MaxSatSolver
+{
+private:
+  MySatModuleCreateCallback create;
+  std::string module_params;
+  SolverBudget budget;
+
+  Glib::Timer timer;
+  MySatModule* volatile current;
+  volatile gint interrupted;
+  const char* stop_reason;
+
+  sigc::signal<void, const std::string&> signal_progress_def;
+
+  /* hard clauses with relaxations and totalizers (to create solver again) */
+  CNF hard;
+  std::auto_ptr<MySatModule> solver;
+  gint32 solver_vars_n;
+  /* weights of assumptions (DIMACS literals) */
+  std::map<gint32, guint64> weights;
+  /* totalizer outputs: output i is true if at least i+1 inputs are true */
+  std::vector<LiteralVector> totalizers;
+  /* assumption (negated output) -> totalizer and its bound */
+  std::map<gint32, std::pair<guint32, guint32> > sum_outputs;
+
+  /* make sure that solver has vars_n free variables */
+  void reserve_vars (gint32 vars_n);
+  void add_hard_clause (const LiteralVector& literals);
+  LiteralVector build_totalizer (LiteralConstIter begin, LiteralConstIter end);
+  void relax_core (const std::vector<gint32>& core, guint64 min_weight);
+  Result solve_assumptions (const std::vector<gint32>& assumptions,
+        std::vector<bool>& model);
+public:
+  MaxSatSolver (MySatModuleCreateCallback create,
+        const std::string& module_params);
+
+  void set_budget (const SolverBudget& new_budget)
+  { budget = new_budget; }
+
+  /*
+   * find model with minimal cost. returns SATISFIABLE if optimum is found,
+   * UNSATISFIABLE if hard clauses are unsatisfiable, UNKNOWN if solving
+   * is stopped (model is best found, empty if not found).
+   * slot is called with every better cost (upper bound).
+   */
+  Result solve (const CNF& cnf, const sigc::slot<void, guint64>& bound_slot,
+        std::vector<bool>& model, guint64& cost);
+
+  sigc::signal<void, const std::string&>& signal_progress ()
+  { return signal_progress_def; }
+
+  /* request stopping of solving (async-signal-safe) */
+  void interrupt ();
+  /* why solve returned UNKNOWN (0 if not stopped) */
+  const char* get_stop_reason () const
+  { return stop_reason; }
+};
+
+#endif /* __MYSAT_MAXSAT_H__ */
@@ -4,14 +4,252 @@
  * License: LGPL v2.0
  */
 
+#include <algorithm>
+#include <cstdlib>
 #include <glibmm.h>
 #include <satutils.h>
 #include "module.h"
 
+SolverStats::SolverStats ()
+    : decisions (0), conflicts (0), propagations (0), restarts (0),
+      learned_clauses (0), learned_literals (0), trail_size (0), ticks (0),
+      memory (0), peak_memory (0)
+{
+}
+
+SolverBudget::SolverBudget ()
+    : conflicts (0), propagations (0), ticks (0), time (0.0), memory (0)
+{
+}
+
 MySatModule::MySatModule ()
+    : deadline (0), interrupted (0), stop_reason (0)
 {
 }
 
 MySatModule::~MySatModule ()
 {
 }
+
+void
+MySatModule::publish_stats (const SolverStats& new_stats)
+{
+  Glib::Threads::Mutex::Lock lock (stats_mutex);
+  stats = new_stats;
+}
+
+void
+MySatModule::get_stats (SolverStats& out_stats) const
+{
+  Glib::Threads::Mutex::Lock lock (stats_mutex);
+  out_stats = stats;
+}
+
+void
+MySatModule::start_budget ()
+{
+  stop_reason = 0;
+  deadline = 0;
+  if (budget.time > 0.0)
+    deadline = g_get_monotonic_time () + gint64 (budget.time * 1.0e6);
+}
+
+bool
+MySatModule::budget_exhausted (guint64 conflicts, guint64 propagations,
+      guint64 ticks)
+{
+  if (g_atomic_int_get (&interrupted) != 0)
+    stop_reason = "interrupted";
+  else if (!terminate_slot.empty () && terminate_slot ())
+    stop_reason = "terminated";
+  else if (budget.conflicts != 0 && conflicts >= budget.conflicts)
+    stop_reason = "conflicts";
+  else if (budget.propagations != 0 && propagations >= budget.propagations)
+    stop_reason = "propagations";
+  else if (budget.ticks != 0 && ticks >= budget.ticks)
+    stop_reason = "ticks";
+  else if (deadline != 0 && g_get_monotonic_time () >= deadline)
+    stop_reason = "time";
+  else
+    return false;
+  return true;
+}
+
+bool
+MySatModule::set_incremental ()
+{
+  return false;
+}
+
+void
+MySatModule::add_clause (const LiteralVector& literals)
+{
+  throw ModuleError (ModuleError::OTHER_ERROR,
+        "Incremental solving is not supported by module");
+}
+
+void
+MySatModule::set_assumptions (const std::vector<gint32>& literals)
+{
+  throw ModuleError (ModuleError::OTHER_ERROR,
+        "Assumptions are not supported by module");
+}
+
+const std::vector<gint32>&
+MySatModule::get_failed_assumptions () const
+{
+  throw ModuleError (ModuleError::OTHER_ERROR,
+        "Assumptions are not supported by module");
+}
+
+Result
+MySatModule::solve_in_time (const SolverBudget& total_budget,
+      const Glib::Timer& timer, std::vector<bool>& model)
+{
+  /* time limits whole computation, other limits every solve */
+  budget = total_budget;
+  if (total_budget.time != 0)
+  {
+    budget.time = total_budget.time - timer.elapsed ();
+    if (budget.time <= 0.0)
+    {
+      budget = total_budget;
+      stop_reason = "time";
+      return UNKNOWN;
+    }
+  }
+  Result result = solve (model);
+  budget = total_budget;
+  return result;
+}
+
+Result
+MySatModule::enumerate_models (const LiteralVector& projection,
+      guint64 max_models,
+      const sigc::slot<void, const std::vector<bool>&>& slot,
+      guint64& models_n)
+{
+  if (!set_incremental ())
+    throw ModuleError (ModuleError::OTHER_ERROR,
+          "Enumeration requires incremental solving");
+
+  const SolverBudget total_budget = budget;
+  Glib::Timer timer;
+  timer.start ();
+  models_n = 0;
+  std::vector<bool> model;
+  LiteralVector blocking;
+  while (max_models == 0 || models_n < max_models)
+  {
+    Result result = solve_in_time (total_budget, timer, model);
+    if (result != SATISFIABLE)
+      return result;
+    models_n++;
+    slot (model);
+
+    /* block model on projected variables */
+    blocking.clear ();
+    if (projection.empty ())
+      for (guint32 i = 0; i < model.size (); i++)
+        blocking.push_back ((model[i]) ? -gint32 (i+1) : gint32 (i+1));
+    else
+      for (guint32 i = 0; i < projection.size (); i++)
+      {
+        gint32 var = projection[i];
+        if (var > 0 && guint32 (var) <= model.size ())
+          blocking.push_back ((model[var-1]) ? -var : var);
+      }
+    add_clause (blocking);
+  }
+  return SATISFIABLE;
+}
+
+static bool
+literal_var_less (gint32 l1, gint32 l2)
+{
+  return std::abs (l1) < std::abs (l2);
+}
+
+Result
+MySatModule::find_backbone (const LiteralVector& variables,
+      LiteralVector& backbone)
+{
+  /* chunk grows while its negations are satisfiable */
+  static const guint32 max_chunk_size = 1024;
+
+  if (!set_incremental ())
+    throw ModuleError (ModuleError::OTHER_ERROR,
+          "Backbone computation requires incremental solving");
+
+  const SolverBudget total_budget = budget;
+  Glib::Timer timer;
+  timer.start ();
+  backbone.clear ();
+  std::vector<bool> model;
+  Result result = solve_in_time (total_budget, timer, model);
+  if (result != SATISFIABLE)
+    return result;
+
+  LiteralVector candidates;
+  if (variables.empty ())
+    for (guint32 i = 0; i < model.size (); i++)
+      candidates.push_back ((model[i]) ? gint32 (i+1) : -gint32 (i+1));
+  else
+    for (guint32 i = 0; i < variables.size (); i++)
+    {
+      gint32 var = variables[i];
+      if (var > 0 && guint32 (var) <= model.size ())
+        candidates.push_back ((model[var-1]) ? var : -var);
+    }
+
+  guint32 chunk_size = 1;
+  std::vector<gint32> assumptions;
+  while (!candidates.empty ())
+  {
+    /* chunk is at end of candidates */
+    assumptions.clear ();
+    for (guint32 i = 0; i < chunk_size && i < candidates.size (); i++)
+      assumptions.push_back (-candidates[candidates.size () - 1 - i]);
+    set_assumptions (assumptions);
+    result = solve_in_time (total_budget, timer, model);
+    if (result == UNKNOWN)
+      break;
+    if (result == SATISFIABLE)
+    {
+      /* candidates false in model are not in backbone */
+      LiteralIter last = candidates.begin ();
+      for (LiteralConstIter it = candidates.begin (); it != candidates.end ();
+           ++it)
+        if (model[std::abs (*it)-1] == (*it > 0))
+          *last++ = *it;
+      candidates.erase (last, candidates.end ());
+      chunk_size = std::min (2*chunk_size, max_chunk_size);
+      continue;
+    }
+
+    const std::vector<gint32>& core = get_failed_assumptions ();
+    if (core.empty ())
+      break; /* formulae is unsatisfiable */
+    LiteralIter candidate = std::find (candidates.begin (), candidates.end (),
+          -core[0]);
+    if (core.size () == 1)
+    {
+      /* negation of candidate is unsatisfiable */
+      backbone.push_back (*candidate);
+      add_clause (LiteralVector (1, *candidate));
+      candidates.erase (candidate);
+    }
+    else
+    {
+      /* test candidates of core separately */
+      std::swap (*candidate, candidates.back ());
+      chunk_size = 1;
+    }
+  }
+  set_assumptions (std::vector<gint32> ());
+  if (candidates.empty ())
+    result = SATISFIABLE;
+
+  std::sort (backbone.begin (), backbone.end (), literal_var_less);
+  return result;
+}
@@ -14,21 +14,135 @@
 
 using namespace SatUtils;
 
+/* solving statistics (snapshot published by module) */
+struct SolverStats
+{
+  guint64 decisions;
+  guint64 conflicts;
+  guint64 propagations;
+  guint64 restarts;
+  guint64 learned_clauses;
+  guint64 learned_literals;
+  guint64 trail_size;
+  guint64 ticks;
+  guint64 memory; /* in bytes */
+  guint64 peak_memory;
+
+  SolverStats ();
+};
+
+/*
+ * limits of solving (zero - no limit). conflicts, propagations and ticks
+ * (deterministic work units: memory accesses in BCP) give same results
+ * on all machines. time is wall-clock time in seconds.
+ */
+struct SolverBudget
+{
+  guint64 conflicts;
+  guint64 propagations;
+  guint64 ticks;
+  double time;
+  /* soft limit of memory in bytes: solver reduces learned clauses near it
+   * and stops if reducing cannot get below it */
+  guint64 memory;
+
+  SolverBudget ();
+};
+
 class MySatModule: public Module
 {
+private:
+  mutable Glib::Threads::Mutex stats_mutex;
+  SolverStats stats;
+
+  SolverBudget budget;
+  gint64 deadline; /* monotonic time, zero if no time limit */
+  volatile gint interrupted;
+  sigc::slot<bool> terminate_slot;
+  const char* stop_reason;
 protected:
   MySatModule ();
 
   sigc::signal<void, const std::string&> signal_progress_def;
 
+  /* publish statistics (can be read by other thread) */
+  void publish_stats (const SolverStats& new_stats);
+
+  /* start measuring time of budget (call at begin of solve) */
+  void start_budget ();
+  /* returns true if solving must be stopped (and sets stop reason) */
+  bool budget_exhausted (guint64 conflicts, guint64 propagations,
+        guint64 ticks);
+  /* for stops checked by module (for example "memory") */
+  void set_stop_reason (const char* reason)
+  { stop_reason = reason; }
+  /* solve with time of total_budget left after time measured by timer */
+  Result solve_in_time (const SolverBudget& total_budget,
+        const Glib::Timer& timer, std::vector<bool>& model);
 public:
   virtual ~MySatModule ();
 
   virtual void fetch_problem (const CNF& cnf) = 0;
   virtual Result solve (std::vector<bool>& model) = 0;
 
+  /*
+   * incremental solving: enabled before first solve, then clauses can be
+   * added and formulae solved again (learned clauses are kept).
+   * returns false if module doesn't support it.
+   */
+  virtual bool set_incremental ();
+  /* add clause (DIMACS literals of fetched variables) between solves */
+  virtual void add_clause (const LiteralVector& literals);
+  /* DIMACS literals assumed to be true by solve */
+  virtual void set_assumptions (const std::vector<gint32>& literals);
+  /* assumptions used to prove unsatisfiability (DIMACS) */
+  virtual const std::vector<gint32>& get_failed_assumptions () const;
+
+  /*
+   * enumerate models different on projected variables (all variables if
+   * projection is empty), each found model is blocked by clause and passed
+   * to slot. stops after max_models models (zero - no limit).
+   * returns UNSATISFIABLE if all models are found, SATISFIABLE if limit is
+   * reached, UNKNOWN if solving is stopped. time of budget limits whole
+   * enumeration. requires incremental solving.
+   */
+  Result enumerate_models (const LiteralVector& projection, guint64 max_models,
+        const sigc::slot<void, const std::vector<bool>&>& slot,
+        guint64& models_n);
+  /*
+   * find backbone: literals of variables (all variables if empty) which are
+   * true in every model. negations of candidates from first model are
+   * assumed in chunks, every found model removes candidates false in it
+   * and backbone literals are added as unit clauses. backbone is sorted
+   * by variables. returns SATISFIABLE if backbone is found, UNSATISFIABLE
+   * if formulae has no model, UNKNOWN if solving is stopped. time of budget
+   * limits whole computation. requires incremental solving.
+   */
+  Result find_backbone (const LiteralVector& variables, LiteralVector& backbone);
+
   sigc::signal<void, const std::string&>& signal_progress ()
   { return signal_progress_def; }
+
+  /* get last published statistics, thread-safe */
+  void get_stats (SolverStats& out_stats) const;
+
+  void set_budget (const SolverBudget& new_budget)
+  { budget = new_budget; }
+  const SolverBudget& get_budget () const
+  { return budget; }
+
+  /* solving is stopped when slot returns true (called periodically
+   * from solving thread) */
+  void set_terminate (const sigc::slot<bool>& slot)
+  { terminate_slot = slot; }
+
+  /* request stopping of solving (async-signal-safe) */
+  void interrupt ()
+  { g_atomic_int_set (&interrupted, 1); }
+
+  /* why solve returned UNKNOWN (0 if not stopped) */
+  const char* get_stop_reason () const
+  { return stop_reason; }
 };
 
 #endif /* __MYSAT_MODULE_H__ */
@@ -9,7 +9,7 @@
 #include "dpll.h"
 #include "cdcl.h"
 
-const MySatModuleInfo modules_info_table[] =
+const MySatModuleInfo solver_modules_info_table[] =
 {
   {
     "dpll",
@@ -18,9 +18,9 @@ struct MySatModuleInfo
   MySatModuleCreateCallback create;
 };
 
-static const guint modules_info_table_size = 2;
+static const guint solver_modules_info_table_size = 2;
 
-extern const MySatModuleInfo modules_info_table[];
+extern const MySatModuleInfo solver_modules_info_table[];
 
 
-#endif /* __SATGEN_MODULES_TABLE_H__ */
+#endif /* __MYSAT_MODULES_TABLE_H__ */
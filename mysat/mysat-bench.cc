@@ -0,0 +1,895 @@
+/*
+ * mysat-bench.cc - benchmark of mysat solvers on generated corpus
+ * Author: Mateusz Szpakowski
+ * License: LGPL v2.0
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <clocale>
+#include <cstring>
+#include <cerrno>
+#include <memory>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <glibmm.h>
+#include <satutils.h>
+#include "modules-table.h"
+#include "satgen/graph-coloring.h"
+#include "satgen/vertex-cover.h"
+#include "satgen/set-cover.h"
+#include "satgen/subset-sum.h"
+#include "satgen/npuzzle.h"
+#include "satgen/eternity.h"
+#include "satgen/sokoban.h"
+#include "satgen/spear-format.h"
+
+using namespace SatUtils;
+
+class BenchOptionGroup: public Glib::OptionGroup
+{
+public:
+  struct OptionState
+  {
+    int seed;
+    int scales_n;
+    int timeout;
+    Glib::ustring configs;
+    Glib::ustring families;
+    std::string csv_file;
+    std::string json_file;
+    std::string corpus_dir;
+    bool list_instances;
+  };
+private:
+  OptionState option_state;
+  Glib::OptionEntry seed_entry;
+  Glib::OptionEntry scales_entry;
+  Glib::OptionEntry timeout_entry;
+  Glib::OptionEntry configs_entry;
+  Glib::OptionEntry families_entry;
+  Glib::OptionEntry csv_file_entry;
+  Glib::OptionEntry json_file_entry;
+  Glib::OptionEntry corpus_dir_entry;
+  Glib::OptionEntry list_instances_entry;
+public:
+  BenchOptionGroup ();
+
+  const OptionState& get_option_state () const
+  { return option_state; }
+};
+
+BenchOptionGroup::BenchOptionGroup ()
+    : Glib::OptionGroup ("mysat-bench group", "MySat Bench Option Group",
+          "MySat Bench Option Group")
+{
+  option_state.seed = 1;
+  option_state.scales_n = 3;
+  option_state.timeout = 60;
+  option_state.list_instances = false;
+
+  seed_entry.set_short_name ('S');
+  seed_entry.set_long_name ("seed");
+  seed_entry.set_description ("set seed of generated corpus");
+  seed_entry.set_arg_description ("SEED");
+  add_entry (seed_entry, option_state.seed);
+
+  scales_entry.set_short_name ('n');
+  scales_entry.set_long_name ("scales");
+  scales_entry.set_description ("set number of scales of instances");
+  scales_entry.set_arg_description ("NUMBER");
+  add_entry (scales_entry, option_state.scales_n);
+
+  timeout_entry.set_short_name ('t');
+  timeout_entry.set_long_name ("timeout");
+  timeout_entry.set_description ("set maximum time to solve single instance");
+  timeout_entry.set_arg_description ("SECONDS");
+  add_entry (timeout_entry, option_state.timeout);
+
+  configs_entry.set_short_name ('C');
+  configs_entry.set_long_name ("configs");
+  configs_entry.set_description (
+        "set solver configurations (default all modules)");
+  configs_entry.set_arg_description ("MODULE[/PARAM[=VALUE]:...],...");
+  add_entry (configs_entry, option_state.configs);
+
+  families_entry.set_short_name ('f');
+  families_entry.set_long_name ("families");
+  families_entry.set_description ("use only specified families of instances");
+  families_entry.set_arg_description ("FAMILY,...");
+  add_entry (families_entry, option_state.families);
+
+  csv_file_entry.set_short_name ('o');
+  csv_file_entry.set_long_name ("csv");
+  csv_file_entry.set_description ("write results as CSV");
+  csv_file_entry.set_arg_description ("FILE");
+  add_entry_filename (csv_file_entry, option_state.csv_file);
+
+  json_file_entry.set_short_name ('j');
+  json_file_entry.set_long_name ("json");
+  json_file_entry.set_description ("write results as JSON");
+  json_file_entry.set_arg_description ("FILE");
+  add_entry_filename (json_file_entry, option_state.json_file);
+
+  corpus_dir_entry.set_short_name ('d');
+  corpus_dir_entry.set_long_name ("corpus-dir");
+  corpus_dir_entry.set_description ("save generated instances to directory");
+  corpus_dir_entry.set_arg_description ("DIRECTORY");
+  add_entry_filename (corpus_dir_entry, option_state.corpus_dir);
+
+  list_instances_entry.set_short_name ('l');
+  list_instances_entry.set_long_name ("list-instances");
+  list_instances_entry.set_description ("only list generated instances");
+  add_entry (list_instances_entry, option_state.list_instances);
+}
+
+/*
+ * random generator (xorshift), same sequence on all platforms
+ */
+
+class BenchRandom
+{
+private:
+  guint64 state;
+public:
+  explicit BenchRandom (guint64 seed)
+      : state (seed * 0x9e3779b97f4a7c15ULL + 0x2545f4914f6cdd1dULL)
+  {
+    if (state == 0)
+      state = 1;
+  }
+
+  guint64 next ()
+  {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+  }
+
+  /* number from range 0..n-1 */
+  guint32 below (guint32 n)
+  { return next () % n; }
+};
+
+typedef SatGenModule* (*BenchGeneratorCreate) ();
+
+/*
+ * instance of corpus. only its generator is kept: instance is generated
+ * again by every solving process, so its memory is not shared by them.
+ */
+struct BenchInstance
+{
+  std::string name;
+  std::string family;
+  guint scale;
+  BenchGeneratorCreate create;
+  std::string params;
+  std::string input;
+  gint32 vars_n;
+  guint32 clauses_n;
+};
+
+/* solver configuration */
+struct BenchConfig
+{
+  guint module_index;
+  std::string params;
+};
+
+/* result sent from child process */
+struct BenchChildResult
+{
+  gint32 status;
+  double time;
+  SolverStats stats;
+};
+
+enum
+{
+  BENCH_UNSAT = 0,
+  BENCH_SAT,
+  BENCH_UNKNOWN,
+  BENCH_BADMODEL,
+  BENCH_ERROR,
+  BENCH_TIMEOUT
+};
+
+static const char* bench_status_names[] =
+{
+  "UNSAT", "SAT", "UNKNOWN", "BADMODEL", "ERROR", "TIMEOUT"
+};
+
+/*
+ * corpus generation
+ */
+
+static std::string
+int_to_string (guint64 value)
+{
+  std::ostringstream os;
+  os << value;
+  return os.str ();
+}
+
+static bool
+is_prime (guint64 value)
+{
+  if (value < 2)
+    return false;
+  for (guint64 d = 2; d*d <= value; d++)
+    if (value % d == 0)
+      return false;
+  return true;
+}
+
+static guint64
+random_prime (BenchRandom& rand, guint bits)
+{
+  while (true)
+  {
+    guint64 value = (rand.next () & ((1ULL<<bits)-1)) | (1ULL<<(bits-1)) | 1;
+    if (is_prime (value))
+      return value;
+  }
+}
+
+static std::string
+random_graph (BenchRandom& rand, guint vertices_n, guint edges_n)
+{
+  std::ostringstream os;
+  std::vector<std::pair<guint32, guint32> > edges;
+  while (edges.size () < edges_n)
+  {
+    guint32 v1 = rand.below (vertices_n);
+    guint32 v2 = rand.below (vertices_n);
+    if (v1 == v2)
+      continue;
+    std::pair<guint32, guint32> edge (std::min (v1, v2), std::max (v1, v2));
+    if (std::find (edges.begin (), edges.end (), edge) != edges.end ())
+      continue;
+    edges.push_back (edge);
+    os << 'v' << edge.first << "-v" << edge.second << '\n';
+  }
+  return os.str ();
+}
+
+static std::string
+random_sets (BenchRandom& rand, guint elems_n, guint sets_n)
+{
+  std::vector<std::vector<guint32> > sets (sets_n);
+  for (guint i = 0; i < sets_n; i++)
+  {
+    guint size = 3 + rand.below (4);
+    for (guint k = 0; k < size; k++)
+      sets[i].push_back (rand.below (elems_n));
+  }
+  /* every element must be in some set */
+  for (guint e = 0; e < elems_n; e++)
+    sets[rand.below (sets_n)].push_back (e);
+
+  std::ostringstream os;
+  for (guint i = 0; i < sets_n; i++)
+  {
+    os << 'S' << i << " = {";
+    for (guint k = 0; k < sets[i].size (); k++)
+      os << " e" << sets[i][k];
+    os << " }\n";
+  }
+  return os.str ();
+}
+
+static std::string
+random_subset_sum (BenchRandom& rand, guint numbers_n, guint bits,
+      guint64& sum)
+{
+  std::ostringstream os;
+  sum = 0;
+  for (guint i = 0; i < numbers_n; i++)
+  {
+    guint64 value = 1 + (rand.next () & ((1ULL<<bits)-1));
+    if (rand.below (2))
+      sum += value;
+    os << value << '\n';
+  }
+  return os.str ();
+}
+
+static std::string
+random_npuzzle (BenchRandom& rand, guint size, guint moves_n)
+{
+  guint elems_n = size*size;
+  std::vector<guint> elems (elems_n);
+  for (guint i = 0; i < elems_n-1; i++)
+    elems[i] = i+1;
+  elems[elems_n-1] = 0;
+
+  /* random walk of empty field from final state */
+  guint empty = elems_n-1;
+  guint prev_empty = elems_n;
+  for (guint i = 0; i < moves_n; )
+  {
+    guint row = empty / size, col = empty % size;
+    guint next = elems_n;
+    switch (rand.below (4))
+    {
+      case 0: if (row > 0) next = empty - size; break;
+      case 1: if (row + 1 < size) next = empty + size; break;
+      case 2: if (col > 0) next = empty - 1; break;
+      default: if (col + 1 < size) next = empty + 1; break;
+    }
+    if (next == elems_n || next == prev_empty)
+      continue;
+    std::swap (elems[empty], elems[next]);
+    prev_empty = empty;
+    empty = next;
+    i++;
+  }
+
+  std::ostringstream os;
+  os << size << ' ' << size << '\n';
+  for (guint i = 0; i < elems_n; i++)
+    os << elems[i] << (((i % size) == size-1) ? '\n' : ' ');
+  return os.str ();
+}
+
+static std::string
+random_eternity (BenchRandom& rand, guint size, guint colors_n)
+{
+  /* edge colors: horizontal and vertical edges, border has color 0 */
+  std::vector<guint> hedges ((size+1)*size);
+  std::vector<guint> vedges (size*(size+1));
+  for (guint i = 0; i < hedges.size (); i++)
+    hedges[i] = 1 + rand.below (colors_n);
+  for (guint i = 0; i < vedges.size (); i++)
+    vedges[i] = 1 + rand.below (colors_n);
+  for (guint i = 0; i < size; i++)
+  {
+    hedges[i] = hedges[size*size + i] = 0;
+    vedges[i*(size+1)] = vedges[i*(size+1) + size] = 0;
+  }
+
+  std::vector<guint> pieces;
+  for (guint y = 0; y < size; y++)
+    for (guint x = 0; x < size; x++)
+    { /* top, right, bottom, left */
+      pieces.push_back (hedges[y*size + x]);
+      pieces.push_back (vedges[y*(size+1) + x+1]);
+      pieces.push_back (hedges[(y+1)*size + x]);
+      pieces.push_back (vedges[y*(size+1) + x]);
+    }
+  /* shuffle pieces */
+  guint pieces_n = size*size;
+  for (guint i = pieces_n-1; i > 0; i--)
+  {
+    guint j = rand.below (i+1);
+    for (guint k = 0; k < 4; k++)
+      std::swap (pieces[i*4+k], pieces[j*4+k]);
+  }
+
+  std::ostringstream os;
+  for (guint i = 0; i < pieces_n; i++)
+    os << pieces[i*4] << ' ' << pieces[i*4+1] << ' ' <<
+        pieces[i*4+2] << ' ' << pieces[i*4+3] << '\n';
+  return os.str ();
+}
+
+static std::string
+factoring_spear (guint bits, guint64 product)
+{
+  std::ostringstream os;
+  guint64 limit = 1ULL << ((bits+1)/2);
+  os << "v 1.0\ne 0\n"
+      "d a:i" << bits << " b:i" << bits << " p:i" << bits <<
+      " ab:i1 bb:i1 a1:i1 b1:i1\n"
+      "c p * a b\n"
+      "c ab ult a " << limit << ":i" << bits << "\n"
+      "c bb ult b " << limit << ":i" << bits << "\n"
+      "c a1 ugt a 1:i" << bits << "\n"
+      "c b1 ugt b 1:i" << bits << "\n"
+      "p = p " << product << ":i" << bits << "\n"
+      "p = ab 1:i1\np = bb 1:i1\np = a1 1:i1\np = b1 1:i1\n";
+  return os.str ();
+}
+
+/* small sokoban levels (XSB format) with number of moves */
+static const char* sokoban_levels =
+  "; mysat-bench levels\n"
+  "\n"
+  "; level 1\n"
+  "#######\n"
+  "#     #\n"
+  "# .$@ #\n"
+  "#     #\n"
+  "#######\n"
+  "\n"
+  "; level 2\n"
+  "#######\n"
+  "#.    #\n"
+  "#  $  #\n"
+  "# $@ .#\n"
+  "#######\n"
+  "\n"
+  "; level 3\n"
+  "########\n"
+  "#.  #  #\n"
+  "# $  $.#\n"
+  "#  @   #\n"
+  "########\n";
+
+static const guint sokoban_levels_n = 3;
+static const guint sokoban_moves[sokoban_levels_n] = { 4, 10, 14 };
+
+static void
+add_instance (std::vector<BenchInstance>& corpus, BenchGeneratorCreate create,
+      const std::string& family, guint scale, const std::string& name,
+      const std::string& params, const std::string& input)
+{
+  BenchInstance instance;
+  instance.family = family;
+  instance.scale = scale;
+  instance.name = family + "-" + int_to_string (scale) + "-" + name;
+  instance.create = create;
+  instance.params = params;
+  instance.input = input;
+  instance.vars_n = 0;
+  instance.clauses_n = 0;
+  corpus.push_back (instance);
+}
+
+static void
+generate_instance (const BenchInstance& instance, CNF& cnf)
+{
+  std::auto_ptr<SatGenModule> module (instance.create ());
+  try
+  {
+    std::string outmap;
+    if (instance.params.size () != 0)
+      module->parse_params (instance.params);
+    module->parse_input (instance.input);
+    module->generate (cnf, outmap, false);
+  }
+  catch (Glib::Error& ex)
+  {
+    throw ModuleError (ModuleError::OTHER_ERROR,
+          "Cant generate " + instance.name + ": " + ex.what ());
+  }
+}
+
+static bool
+family_enabled (const std::string& families, const std::string& family)
+{
+  if (families.size () == 0)
+    return true;
+  std::istringstream is (families);
+  std::string name;
+  while (std::getline (is, name, ','))
+    if (name == family)
+      return true;
+  return false;
+}
+
+static void
+generate_corpus (guint32 seed, guint scales_n, const std::string& families,
+      std::vector<BenchInstance>& corpus)
+{
+  for (guint scale = 1; scale <= scales_n; scale++)
+  {
+    /* each family and scale has own random sequence */
+    if (family_enabled (families, "graph-coloring"))
+    {
+      BenchRandom rand (seed*1000 + scale*10 + 1);
+      guint vertices_n = 30 + 20*scale;
+      add_instance (corpus, GraphColoringModule::create,
+          "graph-coloring", scale, "c3", "colors=3",
+          random_graph (rand, vertices_n, vertices_n*22/10));
+    }
+    if (family_enabled (families, "vertex-cover"))
+    {
+      BenchRandom rand (seed*1000 + scale*10 + 2);
+      guint vertices_n = 20 + 10*scale;
+      add_instance (corpus, VertexCoverModule::create,
+          "vertex-cover", scale, "half",
+          "cover_size=" + int_to_string (vertices_n/2),
+          random_graph (rand, vertices_n, vertices_n*2));
+    }
+    if (family_enabled (families, "set-cover"))
+    {
+      BenchRandom rand (seed*1000 + scale*10 + 3);
+      guint sets_n = 15 + 5*scale;
+      add_instance (corpus, SetCoverModule::create,
+          "set-cover", scale, "third",
+          "cover_size=" + int_to_string (sets_n/3),
+          random_sets (rand, 20 + 10*scale, sets_n));
+    }
+    if (family_enabled (families, "subset-sum"))
+    {
+      BenchRandom rand (seed*1000 + scale*10 + 4);
+      guint64 sum;
+      std::string input = random_subset_sum (rand, 12 + 4*scale,
+          10 + 2*scale, sum);
+      add_instance (corpus, SubsetSumModule::create,
+          "subset-sum", scale, "half", "sum=" + int_to_string (sum), input);
+    }
+    if (family_enabled (families, "npuzzle"))
+    {
+      BenchRandom rand (seed*1000 + scale*10 + 5);
+      guint moves_n = 8 + 4*scale;
+      add_instance (corpus, NPuzzleModule::create,
+          "npuzzle", scale, "3x3", "moves=" + int_to_string (moves_n),
+          random_npuzzle (rand, 3, moves_n));
+    }
+    if (family_enabled (families, "eternity"))
+    {
+      BenchRandom rand (seed*1000 + scale*10 + 6);
+      add_instance (corpus, EternityModule::create,
+          "eternity", scale, "board", "",
+          random_eternity (rand, 2 + scale, 2 + scale));
+    }
+    if (family_enabled (families, "sokoban"))
+    {
+      guint levelno = (scale-1) % sokoban_levels_n;
+      add_instance (corpus, SokobanModule::create,
+          "sokoban", scale, "level" + int_to_string (levelno+1),
+          "levelno=" + int_to_string (levelno) + ":moves=" +
+          int_to_string (sokoban_moves[levelno]), sokoban_levels);
+    }
+    if (family_enabled (families, "spear-format"))
+    {
+      BenchRandom rand (seed*1000 + scale*10 + 8);
+      guint factor_bits = 6 + 3*scale;
+      guint64 p1 = random_prime (rand, factor_bits);
+      guint64 p2 = random_prime (rand, factor_bits);
+      add_instance (corpus, SpearFormatModule::create,
+          "spear-format", scale, "factor", "",
+          factoring_spear (2*factor_bits, p1*p2));
+      add_instance (corpus, SpearFormatModule::create,
+          "spear-format", scale, "prime", "",
+          factoring_spear (2*factor_bits, random_prime (rand, 2*factor_bits)));
+    }
+  }
+}
+
+/*
+ * running solvers
+ */
+
+static void
+parse_configs (const std::string& configs_string,
+      std::vector<BenchConfig>& configs)
+{
+  configs.clear ();
+  if (configs_string.size () == 0)
+  {
+    for (guint i = 0; i < solver_modules_info_table_size; i++)
+    {
+      BenchConfig config;
+      config.module_index = i;
+      configs.push_back (config);
+    }
+    return;
+  }
+
+  std::istringstream is (configs_string);
+  std::string config_string;
+  while (std::getline (is, config_string, ','))
+  {
+    BenchConfig config;
+    std::string::size_type slash = config_string.find ('/');
+    std::string name = config_string.substr (0, slash);
+    if (slash != std::string::npos)
+      config.params = config_string.substr (slash+1);
+    for (config.module_index = 0;
+         config.module_index < solver_modules_info_table_size;
+         config.module_index++)
+      if (solver_modules_info_table[config.module_index].name == name)
+        break;
+    if (config.module_index == solver_modules_info_table_size)
+      throw ModuleError (ModuleError::BAD_VALUE, "Unknown module " + name);
+    /* check parameters */
+    std::auto_ptr<MySatModule> module (
+        solver_modules_info_table[config.module_index].create ());
+    if (config.params.size () != 0)
+      module->parse_params (config.params);
+    configs.push_back (config);
+  }
+}
+
+/* solve in child process */
+static void
+run_child (int fd, const BenchInstance& instance, const BenchConfig& config,
+      int timeout)
+{
+  BenchChildResult result;
+  result.status = BENCH_ERROR;
+  result.time = 0.0;
+  try
+  {
+    std::auto_ptr<MySatModule> module (
+        solver_modules_info_table[config.module_index].create ());
+    if (config.params.size () != 0)
+      module->parse_params (config.params);
+    SolverBudget budget;
+    budget.time = timeout;
+    module->set_budget (budget);
+    CNF instance_cnf;
+    generate_instance (instance, instance_cnf);
+    CNF cnf (instance_cnf);
+    cnf.normalize_clauses ();
+    module->fetch_problem (cnf);
+
+    std::vector<bool> model;
+    Glib::Timer timer;
+    timer.start ();
+    Result solve_result = module->solve (model);
+    timer.stop ();
+    result.time = timer.elapsed ();
+    module->get_stats (result.stats);
+
+    if (solve_result == SATISFIABLE)
+      result.status = (instance_cnf.evaluate (model)) ? BENCH_SAT :
+          BENCH_BADMODEL;
+    else if (solve_result == UNSATISFIABLE)
+      result.status = BENCH_UNSAT;
+    else if (module->get_stop_reason () != 0 &&
+        strcmp (module->get_stop_reason (), "time") == 0)
+      result.status = BENCH_TIMEOUT;
+    else
+      result.status = BENCH_UNKNOWN;
+  }
+  catch (Glib::Error& ex)
+  {
+    std::cerr << instance.name << ": " << ex.what () << std::endl;
+  }
+  catch (std::exception& ex)
+  {
+    std::cerr << instance.name << ": " << ex.what () << std::endl;
+  }
+  if (write (fd, &result, sizeof (result)) != sizeof (result))
+    _exit (1);
+  _exit (0);
+}
+
+/* time (in seconds) after timeout to kill not responding solver */
+static const int kill_delay = 5;
+
+struct BenchRun
+{
+  const BenchInstance* instance;
+  const BenchConfig* config;
+  BenchChildResult result;
+  double wall_time;
+  guint64 peak_rss; /* in kilobytes */
+};
+
+static void
+run_instance (BenchRun& run, int timeout)
+{
+  run.result.status = BENCH_ERROR;
+  run.result.time = 0.0;
+  run.wall_time = 0.0;
+  run.peak_rss = 0;
+
+  int fds[2];
+  if (pipe (fds) != 0)
+    throw Glib::FileError (Glib::FileError::FAILED, "Cant create pipe");
+
+  std::cout.flush ();
+  gint64 start_time = g_get_monotonic_time ();
+  pid_t pid = fork ();
+  if (pid < 0)
+  {
+    close (fds[0]);
+    close (fds[1]);
+    throw Glib::FileError (Glib::FileError::FAILED, "Cant fork process");
+  }
+  if (pid == 0)
+  {
+    close (fds[0]);
+    run_child (fds[1], *run.instance, *run.config, timeout);
+  }
+  close (fds[1]);
+
+  /* solver stops itself after timeout, kill it if it does not */
+  gint64 deadline = start_time + gint64 (timeout + kill_delay) * 1000000;
+  struct rusage usage;
+  memset (&usage, 0, sizeof (usage));
+  int status;
+  bool wait_failed = false;
+  bool timed_out = false;
+  while (true)
+  {
+    pid_t ret = wait4 (pid, &status, WNOHANG, &usage);
+    if (ret == pid)
+      break;
+    if (ret < 0 && errno != EINTR)
+    {
+      wait_failed = true;
+      break;
+    }
+    if (g_get_monotonic_time () >= deadline)
+    {
+      kill (pid, SIGKILL);
+      wait4 (pid, &status, 0, &usage);
+      timed_out = true;
+      break;
+    }
+    g_usleep (2000);
+  }
+  run.wall_time = double (g_get_monotonic_time () - start_time) * 1.0e-6;
+  run.peak_rss = usage.ru_maxrss;
+
+  if (timed_out)
+    run.result.status = BENCH_TIMEOUT;
+  else if (!wait_failed)
+  {
+    BenchChildResult result;
+    if (read (fds[0], &result, sizeof (result)) == sizeof (result))
+      run.result = result;
+  }
+  close (fds[0]);
+}
+
+static std::string
+config_name (const BenchConfig& config)
+{
+  std::string name = solver_modules_info_table[config.module_index].name;
+  if (config.params.size () != 0)
+    name += "/" + config.params;
+  return name;
+}
+
+static double
+props_per_sec (const BenchRun& run)
+{
+  return (run.result.time > 0.0) ?
+      double (run.result.stats.propagations) / run.result.time : 0.0;
+}
+
+static void
+write_csv (std::ostream& os, const std::vector<BenchRun>& runs)
+{
+  os << "instance,family,scale,vars,clauses,config,status,wall_time,"
+      "solve_time,propagations,props_per_sec,conflicts,decisions,"
+      "peak_rss_kb\n";
+  for (guint i = 0; i < runs.size (); i++)
+  {
+    const BenchRun& run = runs[i];
+    os << run.instance->name << ',' << run.instance->family << ',' <<
+        run.instance->scale << ',' << run.instance->vars_n << ',' <<
+        run.instance->clauses_n << ',' <<
+        '"' << config_name (*run.config) << "\"," <<
+        bench_status_names[run.result.status] << ',' <<
+        run.wall_time << ',' << run.result.time << ',' <<
+        run.result.stats.propagations << ',' << props_per_sec (run) << ',' <<
+        run.result.stats.conflicts << ',' << run.result.stats.decisions << ',' <<
+        run.peak_rss << '\n';
+  }
+}
+
+static void
+write_json (std::ostream& os, const std::vector<BenchRun>& runs)
+{
+  os << "[\n";
+  for (guint i = 0; i < runs.size (); i++)
+  {
+    const BenchRun& run = runs[i];
+    os << "  {\"instance\":\"" << run.instance->name << "\","
+        "\"family\":\"" << run.instance->family << "\","
+        "\"scale\":" << run.instance->scale << ","
+        "\"vars\":" << run.instance->vars_n << ","
+        "\"clauses\":" << run.instance->clauses_n << ","
+        "\"config\":\"" << config_name (*run.config) << "\","
+        "\"status\":\"" << bench_status_names[run.result.status] << "\","
+        "\"wall_time\":" << run.wall_time << ","
+        "\"solve_time\":" << run.result.time << ","
+        "\"propagations\":" << run.result.stats.propagations << ","
+        "\"props_per_sec\":" << props_per_sec (run) << ","
+        "\"conflicts\":" << run.result.stats.conflicts << ","
+        "\"decisions\":" << run.result.stats.decisions << ","
+        "\"peak_rss_kb\":" << run.peak_rss << "}" <<
+        ((i+1 < runs.size ()) ? ",\n" : "\n");
+  }
+  os << "]\n";
+}
+
+/* main function */
+
+int
+main (int argc, char** argv)
+{
+  setlocale (LC_ALL, "");
+  setlocale (LC_NUMERIC, "C");
+
+  Glib::init ();
+
+  BenchOptionGroup option_group;
+  Glib::OptionContext option_context;
+  option_context.set_main_group (option_group);
+
+  try
+  {
+    option_context.parse (argc, argv);
+  }
+  catch (Glib::Exception& ex)
+  {
+    std::cerr << ex.what () << std::endl;
+    return 1;
+  }
+
+  const BenchOptionGroup::OptionState& option_state =
+      option_group.get_option_state ();
+
+  if (option_state.scales_n <= 0 || option_state.timeout <= 0)
+  {
+    std::cerr << "Scales number and timeout must be positive." << std::endl;
+    return 1;
+  }
+
+  try
+  {
+    std::vector<BenchConfig> configs;
+    parse_configs (option_state.configs, configs);
+
+    std::vector<BenchInstance> corpus;
+    generate_corpus (option_state.seed, option_state.scales_n,
+        option_state.families, corpus);
+
+    /* instances are not kept, solving processes generate them again */
+    for (guint i = 0; i < corpus.size (); i++)
+    {
+      CNF cnf;
+      generate_instance (corpus[i], cnf);
+      corpus[i].vars_n = cnf.get_vars_n ();
+      corpus[i].clauses_n = cnf.get_clauses_n ();
+      if (option_state.list_instances)
+        std::cout << corpus[i].name << ": vars=" << corpus[i].vars_n <<
+            " clauses=" << corpus[i].clauses_n << std::endl;
+      if (option_state.corpus_dir.size () != 0)
+        cnf.save_to_file (option_state.corpus_dir + "/" +
+            corpus[i].name + ".cnf");
+    }
+    if (option_state.list_instances)
+      return 0;
+
+    std::vector<BenchRun> runs;
+    for (guint i = 0; i < corpus.size (); i++)
+      for (guint c = 0; c < configs.size (); c++)
+      {
+        BenchRun run;
+        run.instance = &corpus[i];
+        run.config = &configs[c];
+        run_instance (run, option_state.timeout);
+        std::cout << "c " << corpus[i].name << " " << config_name (configs[c]) <<
+            ": " << bench_status_names[run.result.status] << " " <<
+            run.wall_time << " sec." << std::endl;
+        runs.push_back (run);
+      }
+
+    if (option_state.csv_file.size () != 0)
+    {
+      std::ofstream os (option_state.csv_file.c_str ());
+      write_csv (os, runs);
+    }
+    else
+      write_csv (std::cout, runs);
+    if (option_state.json_file.size () != 0)
+    {
+      std::ofstream os (option_state.json_file.c_str ());
+      write_json (os, runs);
+    }
+  }
+  catch (Glib::Exception& ex)
+  {
+    std::cerr << ex.what () << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -7,6 +7,7 @@
 #ifndef __MYSAT_MYSAT_TYPES_H__
 #define __MYSAT_MYSAT_TYPES_H__
 
+#include <algorithm>
 #include <vector>
 #include <glibmm.h>
 
@@ -68,20 +69,71 @@ struct AssignLiteral
   }
 };
 
-class AssignVector: public std::vector<AssignLiteral>
+/*
+ * vector of assignments of variables. storage is padded by elements
+ * beyond size, because vectorized lit_scan loads dword at value
+ * of the last variable.
+ */
+class AssignVector
 {
+private:
+  typedef std::vector<AssignLiteral> Storage;
+  static const guint32 padding = 3;
+
+  Storage storage;
+  guint32 size_n;
 public:
-  AssignVector()
+  typedef Storage::value_type value_type;
+  typedef Storage::size_type size_type;
+  typedef Storage::reference reference;
+  typedef Storage::const_reference const_reference;
+  typedef Storage::iterator iterator;
+  typedef Storage::const_iterator const_iterator;
+
+  AssignVector() : storage (padding), size_n (0)
   { }
-  AssignVector(int n) : std::vector<AssignLiteral> (n)
+  explicit AssignVector(guint32 n) : storage (n + padding), size_n (n)
   { }
-  AssignVector(int n, const AssignLiteral& c) :
-      std::vector<AssignLiteral> (n, c)
+  AssignVector(guint32 n, const AssignLiteral& c) :
+      storage (n + padding, c), size_n (n)
   { }
   template<typename Iter>
-  AssignVector(Iter first, Iter last) :
-      std::vector<AssignLiteral> (first, last)
-  { }
+  AssignVector(Iter first, Iter last) : storage (first, last)
+  {
+    size_n = storage.size ();
+    storage.resize (size_n + padding);
+  }
+
+  size_type size() const
+  { return size_n; }
+  bool empty() const
+  { return size_n == 0; }
+  void resize(guint32 n, const AssignLiteral& c = AssignLiteral ())
+  {
+    /* padding elements become ordinary elements */
+    if (n > size_n)
+      std::fill (storage.begin () + size_n,
+            storage.begin () + std::min (n, size_n + padding), c);
+    storage.resize (n + padding, c);
+    size_n = n;
+  }
+
+  reference operator[](size_type i)
+  { return storage[i]; }
+  const_reference operator[](size_type i) const
+  { return storage[i]; }
+  iterator begin()
+  { return storage.begin (); }
+  iterator end()
+  { return storage.begin () + size_n; }
+  const_iterator begin() const
+  { return storage.begin (); }
+  const_iterator end() const
+  { return storage.begin () + size_n; }
+
+  /* bytes of values for lit_scan (readable up to size()+padding) */
+  const guchar* values() const
+  { return &storage[0].assign; }
 
   void set(gint32 lit)
   {
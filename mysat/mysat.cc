@@ -5,6 +5,8 @@
  */
 
 #include <iostream>
+#include <sstream>
+#include <iomanip>
 #include <algorithm>
 #include <clocale>
 #include <cstring>
@@ -13,6 +15,9 @@
 #include <glibmm.h>
 #include <satutils.h>
 #include "modules-table.h"
+#include "approx-count.h"
+#include "maxsat.h"
+#include "stats-reporter.h"
 
 using namespace SatUtils;
 
@@ -26,11 +31,23 @@ public:
     bool progress;
     bool simplify;
     int timeout;
+    Glib::ustring max_conflicts;
+    Glib::ustring max_propagations;
+    Glib::ustring max_ticks;
+    int mem_limit;
     bool check_model;
     bool no_model;
+    Glib::ustring enumerate;
+    bool approx_count;
+    bool backbone;
+    double epsilon;
+    double delta;
+    int seed;
     bool verbose;
     bool list_modules;
     bool list_params;
+    std::string stats_json;
+    int stats_interval;
   };
 private:
   OptionState option_state;
@@ -38,12 +55,24 @@ private:
   Glib::OptionEntry module_params_entry;
   Glib::OptionEntry progress_entry;
   Glib::OptionEntry timeout_entry;
+  Glib::OptionEntry max_conflicts_entry;
+  Glib::OptionEntry max_propagations_entry;
+  Glib::OptionEntry max_ticks_entry;
+  Glib::OptionEntry mem_limit_entry;
   Glib::OptionEntry simplify_entry;
   Glib::OptionEntry check_model_entry;
   Glib::OptionEntry no_model_entry;
+  Glib::OptionEntry enumerate_entry;
+  Glib::OptionEntry approx_count_entry;
+  Glib::OptionEntry backbone_entry;
+  Glib::OptionEntry epsilon_entry;
+  Glib::OptionEntry delta_entry;
+  Glib::OptionEntry seed_entry;
   Glib::OptionEntry verbose_entry;
   Glib::OptionEntry list_modules_entry;
   Glib::OptionEntry list_params_entry;
+  Glib::OptionEntry stats_json_entry;
+  Glib::OptionEntry stats_interval_entry;
 public:
   MySatOptionGroup ();
 
@@ -61,7 +90,14 @@ MySatOptionGroup::MySatOptionGroup ()
   option_state.simplify = false;
   option_state.check_model = false;
   option_state.no_model = false;
+  option_state.approx_count = false;
+  option_state.backbone = false;
+  option_state.epsilon = 0.8;
+  option_state.delta = 0.2;
+  option_state.seed = 1;
   option_state.timeout = -1;
+  option_state.mem_limit = 0;
+  option_state.stats_interval = 1000;
 
   module_name_entry.set_short_name ('M');
   module_name_entry.set_long_name ("module");
@@ -91,6 +127,32 @@ MySatOptionGroup::MySatOptionGroup ()
   timeout_entry.set_arg_description ("SECONDS");
   add_entry (timeout_entry, option_state.timeout);
 
+  max_conflicts_entry.set_short_name ('C');
+  max_conflicts_entry.set_long_name ("conflicts");
+  max_conflicts_entry.set_description ("set maximum number of conflicts");
+  max_conflicts_entry.set_arg_description ("NUMBER[k|M|G]");
+  add_entry (max_conflicts_entry, option_state.max_conflicts);
+
+  max_propagations_entry.set_short_name ('R');
+  max_propagations_entry.set_long_name ("propagations");
+  max_propagations_entry.set_description ("set maximum number of propagations");
+  max_propagations_entry.set_arg_description ("NUMBER[k|M|G]");
+  add_entry (max_propagations_entry, option_state.max_propagations);
+
+  max_ticks_entry.set_short_name ('T');
+  max_ticks_entry.set_long_name ("ticks");
+  max_ticks_entry.set_description (
+        "set maximum number of ticks (deterministic work units)");
+  max_ticks_entry.set_arg_description ("NUMBER[k|M|G]");
+  add_entry (max_ticks_entry, option_state.max_ticks);
+
+  mem_limit_entry.set_short_name ('m');
+  mem_limit_entry.set_long_name ("mem-limit");
+  mem_limit_entry.set_description (
+        "set memory limit (learned clauses are reduced near it)");
+  mem_limit_entry.set_arg_description ("MB");
+  add_entry (mem_limit_entry, option_state.mem_limit);
+
   simplify_entry.set_short_name ('s');
   simplify_entry.set_long_name ("simplify");
   simplify_entry.set_description ("simplify input formulae");
@@ -111,10 +173,60 @@ MySatOptionGroup::MySatOptionGroup ()
   no_model_entry.set_description ("dont print model");
   add_entry (no_model_entry, option_state.no_model);
 
+  enumerate_entry.set_short_name ('e');
+  enumerate_entry.set_long_name ("enumerate");
+  enumerate_entry.set_description ("enumerate models different on projection "
+        "('c p show' lines) by incremental solving (0 - all models)");
+  enumerate_entry.set_arg_description ("NUMBER[k|M|G]");
+  add_entry (enumerate_entry, option_state.enumerate);
+
+  approx_count_entry.set_short_name ('a');
+  approx_count_entry.set_long_name ("approx-count");
+  approx_count_entry.set_description ("count models approximately "
+        "(on projection) by random XOR hashing");
+  add_entry (approx_count_entry, option_state.approx_count);
+
+  backbone_entry.set_short_name ('b');
+  backbone_entry.set_long_name ("backbone");
+  backbone_entry.set_description ("find literals (of projection) "
+        "true in every model");
+  add_entry (backbone_entry, option_state.backbone);
+
+  epsilon_entry.set_short_name ('E');
+  epsilon_entry.set_long_name ("epsilon");
+  epsilon_entry.set_description ("set tolerance of approximate count");
+  epsilon_entry.set_arg_description ("EPSILON");
+  add_entry (epsilon_entry, option_state.epsilon);
+
+  delta_entry.set_short_name ('D');
+  delta_entry.set_long_name ("delta");
+  delta_entry.set_description ("set confidence of approximate count "
+        "(probability of error)");
+  delta_entry.set_arg_description ("DELTA");
+  add_entry (delta_entry, option_state.delta);
+
+  seed_entry.set_short_name ('S');
+  seed_entry.set_long_name ("seed");
+  seed_entry.set_description ("set seed of random hashes");
+  seed_entry.set_arg_description ("SEED");
+  add_entry (seed_entry, option_state.seed);
+
   verbose_entry.set_short_name ('v');
   verbose_entry.set_long_name ("verbose");
   verbose_entry.set_description ("verbose mode");
   add_entry (verbose_entry, option_state.verbose);
+
+  stats_json_entry.set_short_name ('j');
+  stats_json_entry.set_long_name ("stats-json");
+  stats_json_entry.set_description ("write statistics as JSON lines to file");
+  stats_json_entry.set_arg_description ("FILE");
+  add_entry_filename (stats_json_entry, option_state.stats_json);
+
+  stats_interval_entry.set_short_name ('i');
+  stats_interval_entry.set_long_name ("stats-interval");
+  stats_interval_entry.set_description ("set statistics sampling interval");
+  stats_interval_entry.set_arg_description ("MILISECONDS");
+  add_entry (stats_interval_entry, option_state.stats_interval);
 }
 
 /* progress handling */
@@ -125,44 +237,117 @@ main_on_progress (const std::string& comment)
   std::cout << "c " << comment << std::endl;
 }
 
-static void
-main_on_timeout (int signo)
-{
-  std::cout.flush ();
-  std::cout << "c TIMEOUT\ns UNKNOWN" << std::endl;
-  _exit (0);
-}
+/* solving module (counter or MaxSAT solver), interrupted by first SIGINT
+ * or SIGTERM */
+static MySatModule* main_module = 0;
+static ApproxCounter* main_counter = 0;
+static MaxSatSolver* main_maxsat = 0;
+static volatile sig_atomic_t main_signals_n = 0;
 
 static void
 main_on_signal (int signo)
 {
+  if ((main_module != 0 || main_counter != 0 || main_maxsat != 0) &&
+      main_signals_n++ == 0)
+  {
+    if (main_counter != 0)
+      main_counter->interrupt ();
+    else if (main_maxsat != 0)
+      main_maxsat->interrupt ();
+    else
+      main_module->interrupt ();
+    return;
+  }
+  /* second signal or not solving yet */
   std::cout.flush ();
   std::cout << "c\nc Terminated by " << strsignal (signo) <<
       "\ns UNKNOWN" << std::endl;
-  exit (0);
+  _exit (0);
 }
 
-/* prepare CNF */
-
 static void
-prepare_cnf (CNF& cnf)
+main_on_stats_dump (int signo)
 {
-  LiteralVector& form = cnf.get_formulae ();
+  StatsReporter::request_dump ();
+}
 
-  guint32 idx = 0;
-  guint32 newidx = 0;
-  for (guint i = 0; i < cnf.get_clauses_n (); i++)
+/* parse number with optional suffix (k, M, G) */
+static bool
+parse_budget_value (const Glib::ustring& str, guint64& value)
+{
+  value = 0;
+  if (str.size () == 0)
+    return true;
+  std::istringstream is (str);
+  is >> value;
+  if (is.fail ())
+    return false;
+  char suffix;
+  if (is >> suffix)
   {
-    guint32 clause_size = form[idx];
-    std::sort (form.begin () + idx + 1, form.begin () + idx + clause_size + 1);
-    LiteralIter it = std::unique_copy(form.begin () + idx + 1,
-	form.begin () + idx + clause_size + 1, form.begin () + newidx + 1);
-    form[newidx] = it - (form.begin() + newidx + 1);
-
-    idx += clause_size + 1;
-    newidx += form[newidx] + 1;
+    if (suffix == 'k')
+      value *= 1000ULL;
+    else if (suffix == 'M')
+      value *= 1000000ULL;
+    else if (suffix == 'G')
+      value *= 1000000000ULL;
+    else
+      return false;
+    if (is >> suffix)
+      return false;
   }
-  form.resize (newidx);
+  return true;
+}
+
+/* printing enumerated models (projected) */
+static const LiteralVector* main_projection = 0;
+static bool main_print_models = true;
+
+static void
+main_on_model (const std::vector<bool>& model)
+{
+  if (!main_print_models)
+    return;
+  std::cout << 'v';
+  if (main_projection->empty ())
+    for (int i = 0; i < int (model.size ()); i++)
+      std::cout << ' ' << ((model[i]) ? (i+1) : (-i-1));
+  else
+    for (guint32 i = 0; i < main_projection->size (); i++)
+    {
+      gint32 var = (*main_projection)[i];
+      std::cout << ' ' << ((model[var-1]) ? var : -var);
+    }
+  std::cout << " 0" << std::endl;
+}
+
+/* printing better costs of MaxSAT solving */
+static void
+main_on_bound (guint64 cost)
+{
+  std::cout << "o " << cost << std::endl;
+}
+
+static void
+print_model (const std::vector<bool>& model)
+{
+  std::cout << 'v';
+  for (int i = 0; i < int (model.size ()); i++)
+    std::cout << ' ' << ((model[i]) ? (i+1) : (-i-1));
+  std::cout << " 0" << std::endl;
+}
+
+static void
+print_stats (const MySatModule& module)
+{
+  SolverStats stats;
+  module.get_stats (stats);
+  std::cout << "c Decisions: " << stats.decisions << "\n"
+      "c Conflicts: " << stats.conflicts << "\n"
+      "c Propagations: " << stats.propagations << "\n"
+      "c Ticks: " << stats.ticks << "\n"
+      "c Restarts: " << stats.restarts << "\n"
+      "c Learned clauses: " << stats.learned_clauses << std::endl;
 }
 
 /* main function */
@@ -205,27 +390,32 @@ main (int argc, char** argv)
   {
     if (option_state.list_modules)
     {
-      for (guint i = 0; i < modules_info_table_size; i++)
-        std::cout << "Module name: " << modules_info_table[i].name << "\n"
-            "Description: " << modules_info_table[i].description << "\n";
+      for (guint i = 0; i < solver_modules_info_table_size; i++)
+        std::cout << "Module name: " <<
+            solver_modules_info_table[i].name << "\n"
+            "Description: " <<
+            solver_modules_info_table[i].description << "\n";
       std::cout.flush ();
     }
 
     bool with_module = false;
+    MySatModuleCreateCallback module_create = 0;
     std::auto_ptr<MySatModule> module;
     if (option_state.module_name.size () != 0)
     {
       guint module_index;
-      for (module_index = 0; module_index < modules_info_table_size;
+      for (module_index = 0; module_index < solver_modules_info_table_size;
            ++module_index)
-	if (modules_info_table[module_index].name == option_state.module_name)
+	if (solver_modules_info_table[module_index].name ==
+	    option_state.module_name)
 	{
 	  module = std::auto_ptr<MySatModule>
-	     (modules_info_table[module_index].create ());
+	     (solver_modules_info_table[module_index].create ());
+	  module_create = solver_modules_info_table[module_index].create;
 	  with_module = true;
 	  break;
 	}
-      if (module_index == modules_info_table_size)
+      if (module_index == solver_modules_info_table_size)
       {
         std::cerr << "Module not found." << std::endl;
         return 1;
@@ -259,20 +449,47 @@ main (int argc, char** argv)
       Result result;
       CNF cnf;
       std::vector<bool> model;
+      std::auto_ptr<StatsReporter> stats_reporter;
+
+      if (option_state.stats_json.size () != 0)
+      {
+        if (option_state.stats_interval <= 0)
+        {
+          std::cerr << "Statistics interval must be positive." << std::endl;
+          return 1;
+        }
+        stats_reporter = std::auto_ptr<StatsReporter> (new StatsReporter (
+              *module, option_state.stats_json, option_state.stats_interval));
+
+        struct sigaction oldsigact, newsigact;
+        newsigact.sa_handler = main_on_stats_dump;
+        sigemptyset (&newsigact.sa_mask);
+        newsigact.sa_flags = SA_RESTART;
+        sigaction (SIGUSR1, &newsigact, &oldsigact);
+      }
 
       if (option_state.progress)
         module->signal_progress ().connect (sigc::ptr_fun (&main_on_progress));
       {
 
+        SolverBudget budget;
         if (option_state.timeout >= 0)
+          budget.time = option_state.timeout;
+        if (option_state.mem_limit < 0)
         {
-          struct sigaction oldsigact, newsigact;
-	  newsigact.sa_handler = main_on_timeout;
-	  sigemptyset (&newsigact.sa_mask);
-	  newsigact.sa_flags = 0;
-	  sigaction (SIGALRM, &newsigact, &oldsigact);
-	  alarm (option_state.timeout);
+          std::cerr << "Memory limit must be positive." << std::endl;
+          return 1;
+        }
+        budget.memory = guint64 (option_state.mem_limit) << 20;
+        if (!parse_budget_value (option_state.max_conflicts, budget.conflicts) ||
+            !parse_budget_value (option_state.max_propagations,
+                  budget.propagations) ||
+            !parse_budget_value (option_state.max_ticks, budget.ticks))
+        {
+          std::cerr << "Wrong budget value." << std::endl;
+          return 1;
         }
+        module->set_budget (budget);
         {
 	  struct sigaction oldsigact, newsigact;
 	  newsigact.sa_handler = main_on_signal;
@@ -289,22 +506,228 @@ main (int argc, char** argv)
         }
       }
 
+      /* enumerate models (zero - all models) */
+      const bool enumerating = option_state.enumerate.size () != 0;
+      guint64 max_models = 0;
+      guint64 models_n = 0;
+      if (!parse_budget_value (option_state.enumerate, max_models))
+      {
+        std::cerr << "Wrong number of models." << std::endl;
+        return 1;
+      }
+      const bool backbone = option_state.backbone;
+      LiteralVector backbone_literals;
+      if (backbone && (enumerating || option_state.approx_count))
+      {
+        std::cerr << "Backbone cant be found with enumeration or "
+            "counting." << std::endl;
+        return 1;
+      }
+      /* approximate model counting */
+      const bool counting = option_state.approx_count;
+      std::auto_ptr<ApproxCounter> counter;
+      ApproxCount approx_count;
+      if (counting)
+      {
+        if (enumerating)
+        {
+          std::cerr << "Enumeration and approximate counting cant be "
+              "used together." << std::endl;
+          return 1;
+        }
+        /* solvers of counter are not reported */
+        if (stats_reporter.get () != 0)
+        {
+          std::cerr << "Statistics cant be written by approximate "
+              "counting." << std::endl;
+          return 1;
+        }
+        counter = std::auto_ptr<ApproxCounter> (new ApproxCounter (
+              module_create, option_state.module_params));
+        counter->set_tolerance (option_state.epsilon, option_state.delta);
+        counter->set_seed (option_state.seed);
+        counter->set_budget (module->get_budget ());
+        if (option_state.progress)
+          counter->signal_progress ().connect (
+                sigc::ptr_fun (&main_on_progress));
+      }
+
       Glib::Timer timer;
 
       cnf.load_from_file (argv[1]);
-      prepare_cnf(cnf);
-      module->fetch_problem(cnf);
+      cnf.normalize_clauses ();
+
+      /* formulae with soft clauses (WCNF) is optimized */
+      const bool optimizing = !enumerating && !counting && !backbone &&
+          cnf.get_softs_n () != 0;
+      std::auto_ptr<MaxSatSolver> maxsat;
+      guint64 cost = 0;
+      if (optimizing)
+      {
+        /* solvers of MaxSAT solver are not reported */
+        if (stats_reporter.get () != 0)
+        {
+          std::cerr << "Statistics cant be written by MaxSAT solving." <<
+              std::endl;
+          return 1;
+        }
+        maxsat = std::auto_ptr<MaxSatSolver> (new MaxSatSolver (
+              module_create, option_state.module_params));
+        maxsat->set_budget (module->get_budget ());
+        if (option_state.progress)
+          maxsat->signal_progress ().connect (
+                sigc::ptr_fun (&main_on_progress));
+      }
+      else
+        module->fetch_problem(cnf);
       //cnf.clear(); /* after fetching this data is obsolete */
 
       timer.start ();
+      if (stats_reporter.get () != 0)
+        stats_reporter->start ();
 
-      result = module->solve (model);
+      if (optimizing)
+      {
+        main_maxsat = maxsat.get ();
+        result = maxsat->solve (cnf, sigc::ptr_fun (&main_on_bound), model,
+              cost);
+        main_maxsat = 0;
+      }
+      else if (counting)
+      {
+        main_counter = counter.get ();
+        result = counter->count (cnf, cnf.get_projection (), approx_count);
+        main_counter = 0;
+      }
+      else if (backbone)
+      {
+        main_module = module.get ();
+        result = module->find_backbone (cnf.get_projection (),
+              backbone_literals);
+      }
+      else if (enumerating)
+      {
+        /* models are printed as they are found */
+        main_projection = &cnf.get_projection ();
+        main_print_models = !option_state.no_model;
+        main_module = module.get ();
+        result = module->enumerate_models (cnf.get_projection (), max_models,
+              sigc::ptr_fun (&main_on_model), models_n);
+      }
+      else
+      {
+        main_module = module.get ();
+        result = module->solve (model);
+      }
+      main_module = 0;
 
       timer.stop ();
+      if (stats_reporter.get () != 0)
+        stats_reporter->stop ();
 
-      if (result == UNKNOWN)
+      if (optimizing)
+      {
+        if (result == UNKNOWN && maxsat->get_stop_reason () != 0)
+          std::cout << "c Stopped: " << maxsat->get_stop_reason () <<
+              std::endl;
+        if (result == SATISFIABLE)
+        {
+          /* exit status of MaxSAT solvers */
+          exit_status = 30;
+          std::cout << "s OPTIMUM FOUND" << std::endl;
+        }
+        else if (result == UNSATISFIABLE)
+        {
+          exit_status = 20;
+          std::cout << "s UNSATISFIABLE" << std::endl;
+        }
+        else if (!model.empty ())
+        {
+          exit_status = 10;
+          std::cout << "s SATISFIABLE" << std::endl;
+        }
+        else
+          std::cout << "s UNKNOWN" << std::endl;
+        if (!model.empty ())
+        {
+          std::cout << "c Cost: " << cost << std::endl;
+          if (!option_state.no_model)
+            print_model (model);
+        }
+      }
+      else if (backbone)
+      {
+        if (result == UNKNOWN && module->get_stop_reason () != 0)
+          std::cout << "c Stopped: " << module->get_stop_reason () << std::endl;
+        if (result == SATISFIABLE)
+        {
+          exit_status = 10;
+          std::cout << "c Backbone size: " << backbone_literals.size () <<
+              "\ns SATISFIABLE\nb";
+          for (LiteralConstIter it = backbone_literals.begin ();
+               it != backbone_literals.end (); ++it)
+            std::cout << ' ' << *it;
+          std::cout << " 0" << std::endl;
+        }
+        else if (result == UNSATISFIABLE)
+        {
+          exit_status = 20;
+          std::cout << "s UNSATISFIABLE" << std::endl;
+        }
+        else
+          std::cout << "s UNKNOWN" << std::endl;
+      }
+      else if (counting)
+      {
+        if (result == UNKNOWN && counter->get_stop_reason () != 0)
+          std::cout << "c Stopped: " << counter->get_stop_reason () <<
+              std::endl;
+        if (result == SATISFIABLE)
+        {
+          exit_status = 10;
+          std::ostringstream log10_os;
+          log10_os << std::setprecision (10) << approx_count.log10 ();
+          std::cout << "s SATISFIABLE\n"
+              "c s type mc\n"
+              "c s log10-estimate " << log10_os.str () << "\n"
+              "c s " << ((approx_count.exact) ? "exact" : "approx") <<
+              " arb int " << approx_count.to_string () << std::endl;
+        }
+        else if (result == UNSATISFIABLE)
+        {
+          exit_status = 20;
+          std::cout << "s UNSATISFIABLE\n"
+              "c s type mc\n"
+              "c s exact arb int 0" << std::endl;
+        }
+        else
+          std::cout << "s UNKNOWN" << std::endl;
+      }
+      else if (enumerating)
+      {
+        if (result == UNKNOWN && module->get_stop_reason () != 0)
+          std::cout << "c Stopped: " << module->get_stop_reason () << std::endl;
+        std::cout << "c Models: " << models_n <<
+            ((result == UNSATISFIABLE) ? " (all)" : "") << std::endl;
+        if (models_n != 0)
+        {
+          exit_status = 10;
+          std::cout << "s SATISFIABLE" << std::endl;
+        }
+        else if (result == UNSATISFIABLE)
+        {
+          exit_status = 20;
+          std::cout << "s UNSATISFIABLE" << std::endl;
+        }
+        else
+          std::cout << "s UNKNOWN" << std::endl;
+      }
+      else if (result == UNKNOWN)
       {
         exit_status = 0;
+        if (module->get_stop_reason () != 0)
+          std::cout << "c Stopped: " << module->get_stop_reason () << std::endl;
+        print_stats (*module);
         std::cout << "s UNKNOWN" << std::endl;
       }
       else if (result == SATISFIABLE)
@@ -313,12 +736,7 @@ main (int argc, char** argv)
         std::cout << "s SATISFIABLE" << std::endl;
         /* print model */
         if (!option_state.no_model)
-        {
-	  std::cout << 'v';
-	  for (int i = 0; i < int (model.size ()); i++)
-	    std::cout << ' ' << ((model[i]) ? (i+1) : (-i-1));
-	  std::cout << " 0" << std::endl;
-        }
+          print_model (model);
 
         bool result = (cnf.evaluate (model));
         if (option_state.check_model)
@@ -332,6 +750,13 @@ main (int argc, char** argv)
         std::cout << "s UNSATISFIABLE" << std::endl;
       }
       std::cout << "c Time: " << timer.elapsed () << " sec." << std::endl;
+      {
+        SolverStats stats;
+        module->get_stats (stats);
+        if (stats.peak_memory != 0)
+          std::cout << "c Peak memory: " << std::setprecision (3) <<
+              (double (stats.peak_memory) / 1048576.0) << " MB" << std::endl;
+      }
     }
     else if (argc >= 2)
     {
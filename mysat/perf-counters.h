@@ -0,0 +1,110 @@
+/*
+ * perf-counters.h - compile-time switchable hot-path counters
+ * Author: Mateusz Szpakowski
+ * License: LGPL v2.0
+ */
+
+#ifndef __MYSAT_PERF_COUNTERS_H__
+#define __MYSAT_PERF_COUNTERS_H__
+
+/*
+ * counters are enabled by defining MYSAT_COUNTERS (cmake -DMYSAT_COUNTERS=ON).
+ * MYSAT_COUNT* macros use 'perf_counters' member of module and
+ * compile to nothing if counters are disabled.
+ */
+
+#ifdef MYSAT_COUNTERS
+
+#include <algorithm>
+#include <string>
+#include <sstream>
+#include <glibmm.h>
+
+enum PerfCounter
+{
+  PC_WATCH_VISITS = 0,  /* visited entries of watched lists */
+  PC_CLAUSE_DEREFS,     /* clauses read by conflict analysis (BCP reads
+                         * clause at every watch visit) */
+  PC_FIRST_WATCH_TRUE,  /* clause skipped, because other watch is true */
+  PC_REPLACE_SEARCHES,  /* searches of replacement watch */
+  PC_BINARY_IMPLS,      /* implications from binary clauses */
+  PC_LONG_IMPLS,        /* implications from longer clauses */
+  PC_MINIMIZE_STEPS,    /* steps of DFS in clause minimization */
+  PC_GC_BYTES,          /* bytes of deleted clauses */
+  PC_LAST
+};
+
+/* histogram of replacement searches: clause lengths 3,4,5-8,9-16,... */
+enum
+{
+  PERF_HIST_N = 12
+};
+
+struct PerfCounters
+{
+  guint64 counters[PC_LAST];
+  guint64 replace_hist[PERF_HIST_N];
+
+  PerfCounters ()
+  { clear (); }
+
+  void clear ()
+  {
+    std::fill (counters, counters + PC_LAST, 0);
+    std::fill (replace_hist, replace_hist + PERF_HIST_N, 0);
+  }
+
+  static guint hist_bucket (guint32 length)
+  {
+    if (length <= 3)
+      return 0;
+    /* number of bits of length-1 minus one */
+    guint bucket = 0;
+    for (length--; length > 1 && bucket + 1 < PERF_HIST_N; length >>= 1)
+      bucket++;
+    return bucket;
+  }
+
+  /* lines with counters to print */
+  std::string to_string () const
+  {
+    static const char* names[PC_LAST] =
+    {
+      "watch visits", "clause derefs", "first watch true",
+      "replace searches", "binary impls", "long impls",
+      "minimize steps", "GC bytes"
+    };
+    std::ostringstream os;
+    for (guint i = 0; i < PC_LAST; i++)
+      os << "counter " << names[i] << ": " << counters[i] << "\n";
+    for (guint i = 0; i < PERF_HIST_N; i++)
+      if (replace_hist[i] != 0)
+      {
+        if (i == 0)
+          os << "replace searches length 3: ";
+        else if (i == 1)
+          os << "replace searches length 4: ";
+        else
+          os << "replace searches length " << ((1U << i) + 1) << '-' <<
+              (1U << (i+1)) << ": ";
+        os << replace_hist[i] << "\n";
+      }
+    return os.str ();
+  }
+};
+
+#define MYSAT_COUNT(which) (perf_counters.counters[which]++)
+#define MYSAT_COUNT_ADD(which, n) (perf_counters.counters[which] += (n))
+#define MYSAT_COUNT_REPLACE(length) \
+  (perf_counters.counters[PC_REPLACE_SEARCHES]++, \
+   perf_counters.replace_hist[PerfCounters::hist_bucket (length)]++)
+
+#else /* MYSAT_COUNTERS */
+
+#define MYSAT_COUNT(which) ((void)0)
+#define MYSAT_COUNT_ADD(which, n) ((void)0)
+#define MYSAT_COUNT_REPLACE(length) ((void)0)
+
+#endif /* MYSAT_COUNTERS */
+
+#endif /* __MYSAT_PERF_COUNTERS_H__ */
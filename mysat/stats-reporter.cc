@@ -0,0 +1,134 @@
+/*
+ * stats-reporter.cc - background reporter of solver statistics
+ * Author: Mateusz Szpakowski
+ * License: LGPL v2.0
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <unistd.h>
+#include <glibmm.h>
+#include "stats-reporter.h"
+
+/* set by signal handler, checked by reporter thread */
+static volatile gint dump_requested = 0;
+
+/* reporter checks dump requests at least with this period (us) */
+static const gint64 dump_check_period = 50000;
+
+guint64
+get_process_rss ()
+{
+  unsigned long pages_n = 0, rss_pages_n = 0;
+  FILE* file = fopen ("/proc/self/statm", "r");
+  if (file == NULL)
+    return 0;
+  if (fscanf (file, "%lu %lu", &pages_n, &rss_pages_n) != 2)
+    rss_pages_n = 0;
+  fclose (file);
+  return guint64 (rss_pages_n) * sysconf (_SC_PAGESIZE);
+}
+
+StatsReporter::StatsReporter (const MySatModule& in_module,
+      const std::string& filename, guint in_interval)
+    : module (in_module), os (filename.c_str ()), interval (in_interval),
+      thread (0), stopped (false), start_time (0), last_time (0)
+{
+  if (!os)
+    throw Glib::FileError (Glib::FileError::FAILED,
+        "Cant open statistics file " + filename);
+  if (interval == 0)
+    interval = 1;
+}
+
+StatsReporter::~StatsReporter ()
+{
+  stop ();
+}
+
+void
+StatsReporter::request_dump ()
+{
+  g_atomic_int_set (&dump_requested, 1);
+}
+
+void
+StatsReporter::start ()
+{
+  start_time = last_time = g_get_monotonic_time ();
+  stopped = false;
+  thread = Glib::Threads::Thread::create (
+        sigc::mem_fun (*this, &StatsReporter::run));
+}
+
+void
+StatsReporter::stop ()
+{
+  if (thread == 0)
+    return;
+  {
+    Glib::Threads::Mutex::Lock lock (mutex);
+    stopped = true;
+    cond.signal ();
+  }
+  thread->join ();
+  thread = 0;
+  write_sample ("final");
+}
+
+void
+StatsReporter::run ()
+{
+  gint64 next_time = start_time + gint64 (interval) * 1000;
+  Glib::Threads::Mutex::Lock lock (mutex);
+  while (!stopped)
+  {
+    gint64 now = g_get_monotonic_time ();
+    if (now >= next_time)
+    {
+      write_sample ("sample");
+      next_time += gint64 (interval) * 1000;
+      if (next_time <= now) /* if sampling is too slow */
+        next_time = now + gint64 (interval) * 1000;
+    }
+    if (g_atomic_int_compare_and_exchange (&dump_requested, 1, 0))
+      write_sample ("signal");
+    cond.wait_until (mutex, std::min (next_time, now + dump_check_period));
+  }
+}
+
+void
+StatsReporter::write_sample (const char* event)
+{
+  SolverStats stats;
+  module.get_stats (stats);
+  gint64 now = g_get_monotonic_time ();
+
+  /* rates from last sample */
+  double period = double (now - last_time) * 1.0e-6;
+  double props_per_sec = 0.0;
+  double conflicts_per_sec = 0.0;
+  if (period > 0.0)
+  {
+    props_per_sec = double (stats.propagations - last_stats.propagations) / period;
+    conflicts_per_sec = double (stats.conflicts - last_stats.conflicts) / period;
+  }
+  last_time = now;
+  last_stats = stats;
+
+  os << "{\"event\":\"" << event << "\","
+      "\"time\":" << double (now - start_time) * 1.0e-6 << ","
+      "\"decisions\":" << stats.decisions << ","
+      "\"conflicts\":" << stats.conflicts << ","
+      "\"propagations\":" << stats.propagations << ","
+      "\"props_per_sec\":" << props_per_sec << ","
+      "\"conflicts_per_sec\":" << conflicts_per_sec << ","
+      "\"restarts\":" << stats.restarts << ","
+      "\"learned_clauses\":" << stats.learned_clauses << ","
+      "\"learned_literals\":" << stats.learned_literals << ","
+      "\"trail_size\":" << stats.trail_size << ","
+      "\"ticks\":" << stats.ticks << ","
+      "\"memory_bytes\":" << stats.memory << ","
+      "\"peak_memory_bytes\":" << stats.peak_memory << ","
+      "\"rss_bytes\":" << get_process_rss () << "}" << std::endl;
+}
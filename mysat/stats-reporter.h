@@ -0,0 +1,53 @@
+/*
+ * stats-reporter.h - background reporter of solver statistics
+ * Author: Mateusz Szpakowski
+ * License: LGPL v2.0
+ */
+
+#ifndef __MYSAT_STATS_REPORTER_H__
+#define __MYSAT_STATS_REPORTER_H__
+
+#include <glibmm.h>
+#include <fstream>
+#include <string>
+#include "module.h"
+
+/*
+ * StatsReporter - samples module statistics every interval (in miliseconds)
+ * in separate thread and writes them as JSON lines
+ */
+class StatsReporter
+{
+private:
+  const MySatModule& module;
+  std::ofstream os;
+  guint interval;
+
+  Glib::Threads::Thread* thread;
+  Glib::Threads::Mutex mutex;
+  Glib::Threads::Cond cond;
+  bool stopped;
+
+  gint64 start_time;
+  gint64 last_time;
+  SolverStats last_stats;
+
+  void run ();
+  void write_sample (const char* event);
+public:
+  StatsReporter (const MySatModule& module, const std::string& filename,
+        guint interval);
+  ~StatsReporter ();
+
+  void start ();
+  /* stop thread and write final sample */
+  void stop ();
+
+  /* request dumping current snapshot (async-signal-safe) */
+  static void request_dump ();
+};
+
+/* resident memory of process in bytes (0 if unknown) */
+guint64 get_process_rss ();
+
+#endif /* __MYSAT_STATS_REPORTER_H__ */
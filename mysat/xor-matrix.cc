@@ -0,0 +1,317 @@
+/*
+ * xor-matrix.cc - XOR constraints matrix with Gauss-Jordan elimination
+ * Author: Mateusz Szpakowski
+ * License: LGPL v2.0
+ */
+
+#include <algorithm>
+#include "xor-matrix.h"
+
+XorMatrix::XorMatrix ()
+    : rows_n (0), cols_n (0), words_n (0), gauss (false), pivots_n (0),
+      lit_values (NULL), var_levels (NULL)
+{
+}
+
+void
+XorMatrix::clear ()
+{
+  rows_n = cols_n = words_n = 0;
+  bits.clear ();
+  rhs.clear ();
+  col2var.clear ();
+  watches.clear ();
+  col_watches.clear ();
+  basic_row.clear ();
+  gauss = false;
+  pivots_n = 0;
+}
+
+guint64
+XorMatrix::get_bytes () const
+{
+  guint64 bytes = bits.capacity ()*sizeof (guint64) + rhs.capacity () +
+      (col2var.capacity () + watches.capacity () +
+       basic_row.capacity ())*sizeof (guint32);
+  for (guint32 i = 0; i < col_watches.size (); i++)
+    bytes += col_watches[i].capacity ()*sizeof (guint32);
+  return bytes;
+}
+
+bool
+XorMatrix::init (const std::vector<guint32>& vars,
+      const std::vector<guint32>& xors, bool use_gauss,
+      guint64 max_gauss_words, const guchar* in_lit_values,
+      const guint32* in_var_levels, ImplVector& impls)
+{
+  clear ();
+  lit_values = in_lit_values;
+  var_levels = in_var_levels;
+
+  col2var = vars;
+  cols_n = vars.size ();
+  for (guint32 i = 0; i < xors.size (); i += xors[i] + 2)
+    rows_n++;
+  if (rows_n == 0)
+    return true;
+
+  words_n = (cols_n + 63) >> 6;
+  bits.assign (guint64 (rows_n) * words_n, 0);
+  rhs.assign (rows_n, 0);
+  guint32 row = 0;
+  for (guint32 i = 0; i < xors.size (); i += xors[i] + 2, row++)
+  {
+    guint64* rowbits = row_bits (row);
+    rhs[row] = xors[i+1];
+    for (guint32 j = 0; j < xors[i]; j++)
+    {
+      guint32 col = xors[i+2+j];
+      rowbits[col>>6] ^= guint64 (1) << (col & 63);
+    }
+  }
+
+  gauss = use_gauss && guint64 (rows_n) * words_n <= max_gauss_words;
+  if (gauss)
+  {
+    eliminate ();
+    for (guint32 r = 0; r < rows_n; r++)
+      if (rhs[r] != 0)
+      {
+        bool zero = true;
+        const guint64* rowbits = row_bits (r);
+        for (guint32 w = 0; w < words_n && zero; w++)
+          zero = (rowbits[w] == 0);
+        if (zero) /* 0 = 1 */
+          return false;
+      }
+    remove_zero_rows ();
+  }
+
+  watches.assign (guint64 (rows_n) << 1, NONE);
+  col_watches.resize (cols_n);
+  for (guint32 r = 0; r < rows_n; r++)
+    if (rewatch (r, impls))
+      return false;
+  return true;
+}
+
+void
+XorMatrix::eliminate ()
+{
+  basic_row.assign (cols_n, NONE);
+  for (guint32 r = 0; r < rows_n; r++)
+  {
+    /* basic columns of previous rows are already eliminated from row */
+    guint64* rowbits = row_bits (r);
+    guint32 w = 0;
+    while (w < words_n && rowbits[w] == 0)
+      w++;
+    if (w == words_n)
+      continue;
+    guint32 col = (w<<6) + __builtin_ctzll (rowbits[w]);
+    basic_row[col] = r;
+    for (guint32 r2 = 0; r2 < rows_n; r2++)
+      if (r2 != r && has (r2, col))
+      {
+        guint64* rowbits2 = row_bits (r2);
+        for (guint32 k = w; k < words_n; k++)
+          rowbits2[k] ^= rowbits[k];
+        rhs[r2] ^= rhs[r];
+      }
+  }
+}
+
+void
+XorMatrix::remove_zero_rows ()
+{
+  guint32 newrows_n = 0;
+  for (guint32 r = 0; r < rows_n; r++)
+  {
+    const guint64* rowbits = row_bits (r);
+    bool zero = true;
+    for (guint32 w = 0; w < words_n && zero; w++)
+      zero = (rowbits[w] == 0);
+    if (zero)
+      continue;
+    if (newrows_n != r)
+    {
+      std::copy (rowbits, rowbits + words_n, row_bits (newrows_n));
+      rhs[newrows_n] = rhs[r];
+    }
+    newrows_n++;
+  }
+  rows_n = newrows_n;
+  bits.resize (guint64 (rows_n) * words_n);
+  rhs.resize (rows_n);
+
+  /* renumber basic rows */
+  basic_row.assign (cols_n, NONE);
+  for (guint32 r = 0; r < rows_n; r++)
+  {
+    const guint64* rowbits = row_bits (r);
+    guint32 w = 0;
+    while (rowbits[w] == 0)
+      w++;
+    basic_row[(w<<6) + __builtin_ctzll (rowbits[w])] = r;
+  }
+}
+
+void
+XorMatrix::set_watches (guint32 row, guint32 col0, guint32 col1)
+{
+  guint32 old0 = watches[row<<1];
+  guint32 old1 = watches[(row<<1) + 1];
+  watches[row<<1] = col0;
+  watches[(row<<1) + 1] = col1;
+  /* rows in lists of old watches are not removed */
+  if (col0 != NONE && col0 != old0 && col0 != old1)
+    col_watches[col0].push_back (row);
+  if (col1 != NONE && col1 != old0 && col1 != old1)
+    col_watches[col1].push_back (row);
+}
+
+bool
+XorMatrix::rewatch (guint32 row, ImplVector& impls)
+{
+  guint32 free0 = NONE, free1 = NONE;
+  guint32 top0 = NONE, top1 = NONE; /* assigned at highest levels */
+  guint32 parity = rhs[row];
+  const guint64* rowbits = row_bits (row);
+  for (guint32 w = 0; w < words_n; w++)
+  {
+    guint64 word = rowbits[w];
+    while (word != 0)
+    {
+      guint32 col = (w<<6) + __builtin_ctzll (word);
+      word &= word - 1;
+      guint32 var = col2var[col];
+      if (!assigned (var))
+      {
+        if (free0 == NONE)
+          free0 = col;
+        else
+        {
+          free1 = col;
+          set_watches (row, free0, free1);
+          return false;
+        }
+        continue;
+      }
+      parity ^= guint32 (var_value (var));
+      guint32 level = var_levels[var];
+      if (top0 == NONE || level > var_levels[col2var[top0]])
+      {
+        top1 = top0;
+        top0 = col;
+      }
+      else if (top1 == NONE || level > var_levels[col2var[top1]])
+        top1 = col;
+    }
+  }
+
+  if (free0 != NONE)
+  {
+    /* unit row */
+    set_watches (row, free0, top0);
+    impls.push_back (Implication (row, col2var[free0], parity != 0));
+    return false;
+  }
+  set_watches (row, top0, top1);
+  return parity != 0;
+}
+
+guint32
+XorMatrix::pivot (guint32 row, guint32 col, ImplVector& impls)
+{
+  /* find unassigned column of row (other columns of row are not basic) */
+  const guint64* rowbits = row_bits (row);
+  guint32 newcol = NONE;
+  for (guint32 w = 0; w < words_n && newcol == NONE; w++)
+  {
+    guint64 word = rowbits[w];
+    while (word != 0)
+    {
+      guint32 c = (w<<6) + __builtin_ctzll (word);
+      word &= word - 1;
+      if (c != col && !assigned (col2var[c]))
+      {
+        newcol = c;
+        break;
+      }
+    }
+  }
+  if (newcol == NONE)
+    return NONE;
+
+  pivots_n++;
+  basic_row[col] = NONE;
+  basic_row[newcol] = row;
+  guint32 conflict_row = NONE;
+  for (guint32 r = 0; r < rows_n; r++)
+    if (r != row && has (r, newcol))
+    {
+      guint64* rowbits2 = row_bits (r);
+      for (guint32 w = 0; w < words_n; w++)
+        rowbits2[w] ^= rowbits[w];
+      rhs[r] ^= rhs[row];
+      /* watches still valid if both are unassigned and in row */
+      guint32 w0 = watches[r<<1], w1 = watches[(r<<1) + 1];
+      if (w0 != NONE && w1 != NONE && has (r, w0) && has (r, w1) &&
+          !assigned (col2var[w0]) && !assigned (col2var[w1]))
+        continue;
+      /* other changed rows must be rewatched, even after conflict */
+      if (rewatch (r, impls) && conflict_row == NONE)
+        conflict_row = r;
+    }
+  return conflict_row;
+}
+
+guint32
+XorMatrix::assign (guint32 col, ImplVector& impls)
+{
+  if (gauss && basic_row[col] != NONE)
+  {
+    guint32 conflict_row = pivot (basic_row[col], col, impls);
+    if (conflict_row != NONE)
+      return conflict_row;
+  }
+
+  std::vector<guint32>& rows = col_watches[col];
+  guint32 j = 0;
+  for (guint32 i = 0; i < rows.size (); i++)
+  {
+    guint32 row = rows[i];
+    if (!watches_col (row, col))
+      continue; /* stale entry */
+    if (rewatch (row, impls))
+    {
+      /* keep remaining rows */
+      if (watches_col (row, col))
+        rows[j++] = row;
+      for (i++; i < rows.size (); i++)
+        rows[j++] = rows[i];
+      rows.resize (j);
+      return row;
+    }
+    if (watches_col (row, col))
+      rows[j++] = row;
+  }
+  rows.resize (j);
+  return NONE;
+}
+
+void
+XorMatrix::row_vars (guint32 row, std::vector<guint32>& vars) const
+{
+  vars.clear ();
+  const guint64* rowbits = row_bits (row);
+  for (guint32 w = 0; w < words_n; w++)
+  {
+    guint64 word = rowbits[w];
+    while (word != 0)
+    {
+      vars.push_back (col2var[(w<<6) + __builtin_ctzll (word)]);
+      word &= word - 1;
+    }
+  }
+}
@@ -0,0 +1,115 @@
+/*
+ * xor-matrix.h - XOR constraints matrix with Gauss-Jordan elimination
+ * Author: Mateusz Szpakowski
+ * License: LGPL v2.0
+ */
+
+#ifndef __MYSAT_XOR_MATRIX_H__
+#define __MYSAT_XOR_MATRIX_H__
+
+#include <vector>
+#include <glibmm.h>
+
+/*
+ * rows are XOR constraints (bitsets over columns and right hand side).
+ * every row watches two columns (unassigned if possible, otherwise
+ * assigned at highest levels), so row is checked when its last variable
+ * is assigned. in Gauss-Jordan mode the matrix is kept in reduced row
+ * echelon form: when basic variable of row is assigned, other unassigned
+ * variable of row becomes basic and it is eliminated from other rows.
+ * rows are linear combinations of input rows, so matrix is not restored
+ * on backtracking. solver keeps separate matrix for every connected
+ * component of XORs, so elimination visits only related rows.
+ */
+class XorMatrix
+{
+public:
+  enum { NONE = G_MAXUINT32 };
+
+  /* row implies value of variable */
+  struct Implication
+  {
+    guint32 row;
+    guint32 var;
+    bool value;
+    Implication (guint32 inrow, guint32 invar, bool invalue)
+        : row (inrow), var (invar), value (invalue)
+    { }
+  };
+  typedef std::vector<Implication> ImplVector;
+
+private:
+  guint32 rows_n;
+  guint32 cols_n;
+  guint32 words_n; /* words per row */
+  std::vector<guint64> bits;
+  std::vector<guchar> rhs;
+
+  std::vector<guint32> col2var;
+
+  std::vector<guint32> watches; /* two columns per row */
+  std::vector<std::vector<guint32> > col_watches; /* rows (lazily removed) */
+
+  bool gauss;
+  std::vector<guint32> basic_row; /* row where column is basic */
+  guint64 pivots_n;
+
+  /* values of literals and levels of variables from solver */
+  const guchar* lit_values;
+  const guint32* var_levels;
+
+  guint64* row_bits (guint32 row)
+  { return &bits[row * words_n]; }
+  const guint64* row_bits (guint32 row) const
+  { return &bits[row * words_n]; }
+  bool has (guint32 row, guint32 col) const
+  { return ((bits[row * words_n + (col>>6)] >> (col & 63)) & 1) != 0; }
+
+  bool assigned (guint32 var) const
+  { return lit_values[var<<1] != 0; }
+  /* true if variable is true (FLAGS_TRUE is 1) */
+  bool var_value (guint32 var) const
+  { return lit_values[var<<1] == 1; }
+  bool watches_col (guint32 row, guint32 col) const
+  { return watches[row<<1] == col || watches[(row<<1) + 1] == col; }
+
+  void set_watches (guint32 row, guint32 col0, guint32 col1);
+  /* find new watches, returns true if row is violated */
+  bool rewatch (guint32 row, ImplVector& impls);
+  /* move basic of row from assigned column, returns conflict row or NONE */
+  guint32 pivot (guint32 row, guint32 col, ImplVector& impls);
+  void eliminate ();
+  void remove_zero_rows ();
+
+public:
+  XorMatrix ();
+
+  /*
+   * vars - variables of columns, xors - rows in form: size, rhs, columns.
+   * returns false if XORs are inconsistent. implications of initial rows
+   * are added to impls.
+   */
+  bool init (const std::vector<guint32>& vars, const std::vector<guint32>& xors,
+        bool use_gauss, guint64 max_gauss_words, const guchar* lit_values,
+        const guint32* var_levels, ImplVector& impls);
+  void clear ();
+
+  bool empty () const
+  { return rows_n == 0; }
+  guint32 get_rows_n () const
+  { return rows_n; }
+  bool is_gauss () const
+  { return gauss; }
+  guint64 get_pivots_n () const
+  { return pivots_n; }
+  /* memory of matrix in bytes */
+  guint64 get_bytes () const;
+
+  /* variable of column was assigned, returns conflict row or NONE */
+  guint32 assign (guint32 col, ImplVector& impls);
+
+  /* variables of row */
+  void row_vars (guint32 row, std::vector<guint32>& vars) const;
+};
+
+#endif /* __MYSAT_XOR_MATRIX_H__ */
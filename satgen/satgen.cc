@@ -8,9 +8,11 @@
 #include <clocale>
 #include <memory>
 #include <fstream>
+#include <sstream>
 #include <glibmm.h>
 #include <satutils.h>
 #include "modules-table.h"
+#include "mysat/modules-table.h"
 
 using namespace SatUtils;
 
@@ -24,6 +26,9 @@ public:
     Glib::ustring module_name;
     Glib::ustring module_params;
     Glib::ustring outmap_file;
+    Glib::ustring solver_name;
+    Glib::ustring solver_params;
+    int enumerate;
     bool list_modules;
     bool list_params;
   };
@@ -32,6 +37,9 @@ private:
   Glib::OptionEntry module_name_entry;
   Glib::OptionEntry module_params_entry;
   Glib::OptionEntry outmap_file_entry;
+  Glib::OptionEntry solver_name_entry;
+  Glib::OptionEntry solver_params_entry;
+  Glib::OptionEntry enumerate_entry;
   Glib::OptionEntry list_modules_entry;
   Glib::OptionEntry list_params_entry;
 public:
@@ -48,6 +56,7 @@ SatGenOptionGroup::SatGenOptionGroup ()
 {
   option_state.list_modules = false;
   option_state.list_params = false;
+  option_state.enumerate = -1;
   
   module_name_entry.set_short_name ('M');
   module_name_entry.set_long_name ("module");
@@ -67,6 +76,26 @@ SatGenOptionGroup::SatGenOptionGroup ()
   outmap_file_entry.set_arg_description ("OUTMAPFILE");
   add_entry (outmap_file_entry, option_state.outmap_file);
   
+  solver_name_entry.set_short_name ('S');
+  solver_name_entry.set_long_name ("solve");
+  solver_name_entry.set_description (
+        "solve generated formulae by mysat module and print values");
+  solver_name_entry.set_arg_description ("MODULE");
+  add_entry (solver_name_entry, option_state.solver_name);
+  
+  solver_params_entry.set_short_name ('Q');
+  solver_params_entry.set_long_name ("solve-params");
+  solver_params_entry.set_description ("set solver module parameters");
+  solver_params_entry.set_arg_description ("PARAM[=VALUE]:...");
+  add_entry (solver_params_entry, option_state.solver_params);
+  
+  enumerate_entry.set_short_name ('e');
+  enumerate_entry.set_long_name ("enumerate");
+  enumerate_entry.set_description ("print NUMBER solutions different on "
+        "outmap variables (0 - all solutions)");
+  enumerate_entry.set_arg_description ("NUMBER");
+  add_entry (enumerate_entry, option_state.enumerate);
+  
   list_modules_entry.set_short_name ('l');
   list_modules_entry.set_long_name ("list-modules");
   list_modules_entry.set_description ("list all modules");
@@ -78,6 +107,87 @@ SatGenOptionGroup::SatGenOptionGroup ()
   add_entry (list_params_entry, option_state.list_params);
 }
 
+/* solving generated formulae (without writing CNF file) */
+
+static int
+solve_and_print (MySatModule& solver, CNF& cnf,
+      const std::string& outmap_string)
+{
+  std::vector<bool> model;
+  
+  cnf.normalize_clauses ();
+  solver.fetch_problem (cnf);
+  Result result = solver.solve (model);
+  
+  if (result == UNKNOWN)
+  {
+    std::cout << "Solving stopped";
+    if (solver.get_stop_reason () != 0)
+      std::cout << ": " << solver.get_stop_reason ();
+    std::cout << std::endl;
+    return 0;
+  }
+  
+  /* model goes straight to outmap */
+  std::istringstream outmap (outmap_string);
+  if (!print_output_based_on_outmap (outmap, model,
+          result == SATISFIABLE, std::cout))
+    return 1;
+  return (result == SATISFIABLE) ? 10 : 20;
+}
+
+/* enumerating solutions: found models are printed through outmap */
+static const std::string* enum_outmap_string = 0;
+static guint64 enum_solutions_n = 0;
+
+static void
+print_solution (const std::vector<bool>& model)
+{
+  enum_solutions_n++;
+  std::cout << "Solution " << enum_solutions_n << ":\n";
+  std::istringstream outmap (*enum_outmap_string);
+  print_output_based_on_outmap (outmap, model, true, std::cout);
+}
+
+static int
+enumerate_and_print (MySatModule& solver, CNF& cnf,
+      const std::string& outmap_string, guint64 max_solutions)
+{
+  /* solutions are different on variables shown by outmap */
+  LiteralVector projection;
+  {
+    std::istringstream outmap (outmap_string);
+    if (!get_outmap_variables (outmap, projection))
+      return 1;
+  }
+  
+  cnf.normalize_clauses ();
+  solver.fetch_problem (cnf);
+  enum_outmap_string = &outmap_string;
+  enum_solutions_n = 0;
+  guint64 solutions_n;
+  Result result = solver.enumerate_models (projection, max_solutions,
+        sigc::ptr_fun (&print_solution), solutions_n);
+  
+  if (result == UNKNOWN)
+  {
+    std::cout << "Solving stopped";
+    if (solver.get_stop_reason () != 0)
+      std::cout << ": " << solver.get_stop_reason ();
+    std::cout << std::endl;
+  }
+  if (solutions_n == 0)
+  {
+    if (result != UNSATISFIABLE)
+      return 0;
+    std::cout << "Formulae is unsatisfiable!" << std::endl;
+    return 20;
+  }
+  std::cout << "Found " << solutions_n << " solutions" <<
+      ((result == UNSATISFIABLE) ? " (all)." : ".") << std::endl;
+  return 10;
+}
+
 /* main function */
 
 int
@@ -105,13 +215,18 @@ main (int argc, char** argv)
   const SatGenOptionGroup::OptionState& option_state =
       option_group.get_option_state ();
   
-  if (!option_state.list_modules && !option_state.list_params)
+  const bool solving = option_state.solver_name.size () != 0;
+  
+  if (!option_state.list_modules && !option_state.list_params && !solving)
     if (argc < 2)
     {
-      std::cout << "Usage: satgen CNFFILE [INPUTFILE]" << std::endl;
+      std::cout << "Usage: satgen CNFFILE [INPUTFILE]\n"
+          "       satgen --solve=MODULE [INPUTFILE]" << std::endl;
       return 0;
     }
   
+  int exit_status = 0;
+  
   try
   {
     if (option_state.list_modules)
@@ -165,14 +280,44 @@ main (int argc, char** argv)
       module->parse_params (option_state.module_params);
     }
     
+    std::auto_ptr<MySatModule> solver;
+    if (solving)
+    {
+      guint solver_index;
+      for (solver_index = 0; solver_index < solver_modules_info_table_size;
+           ++solver_index)
+	if (solver_modules_info_table[solver_index].name ==
+	    option_state.solver_name)
+	{
+	  solver = std::auto_ptr<MySatModule>
+	     (solver_modules_info_table[solver_index].create ());
+	  break;
+	}
+      if (solver_index == solver_modules_info_table_size)
+      {
+        std::cerr << "Solver module not found." << std::endl;
+        return 1;
+      }
+      if (option_state.solver_params.size () != 0)
+        solver->parse_params (option_state.solver_params);
+    }
+    else if (option_state.solver_params.size () != 0 ||
+        option_state.enumerate >= 0)
+    {
+      std::cerr << "Solver module must be specified." << std::endl;
+      return 1;
+    }
+    
     if (with_module)
     {
-      if (argc >= 2)
+      /* in solving mode first argument is input file */
+      const int input_index = (solving) ? 1 : 2;
+      if (argc >= 2 || solving)
       {
 	std::string input_string;
-	if (argc >= 3)
+	if (argc > input_index)
 	{
-	  std::ifstream file (argv[2], std::ios::in);
+	  std::ifstream file (argv[input_index], std::ios::in);
 	  if (!file)
 	  {
 	    std::cerr << "Input file: Open error" << std::endl;
@@ -204,7 +349,7 @@ main (int argc, char** argv)
 	  std::string outmap_string;
 	  module->parse_input (input_string);
 	  module->generate (cnf, outmap_string,
-	           option_state.outmap_file.size () != 0);
+	           solving || option_state.outmap_file.size () != 0);
 	  
 	  /* saving result */
 	  if (option_state.outmap_file.size ())
@@ -219,7 +364,16 @@ main (int argc, char** argv)
 	    ofile.exceptions (std::ios_base::badbit);
 	    ofile << outmap_string;
 	  }
-	  cnf.save_to_file (argv[1]);
+	  if (solving)
+	  {
+	    if (option_state.enumerate >= 0)
+	      exit_status = enumerate_and_print (*solver, cnf, outmap_string,
+	             option_state.enumerate);
+	    else
+	      exit_status = solve_and_print (*solver, cnf, outmap_string);
+	  }
+	  else
+	    cnf.save_to_file (argv[1]);
 	}
       }
       else
@@ -228,7 +382,7 @@ main (int argc, char** argv)
         return 1;
       }
     }
-    else if (argc >= 2)
+    else if (argc >= 2 || solving)
     {
       std::cerr << "Module must be specified" << std::endl;
       return 1;
@@ -245,5 +399,5 @@ main (int argc, char** argv)
     return 1;
   }
   
-  return 0;
+  return exit_status;
 }
@@ -13,9 +13,10 @@
 using namespace SatUtils;
 
 SetCoverModule::SetCoverModule ()
-    : cover_size (3)
+    : cover_size (3), opb (false)
 {
   add_param ("cover_size", "Cover size", cover_size);
+  add_param ("opb", "Generate pseudo-Boolean constraint (OPB)", opb);
 }
 
 SetCoverModule::~SetCoverModule ()
@@ -178,6 +179,14 @@ SetCoverModule::generate (CNF& cnf, std::string& outmap_string,
     cnf.add_clause (clause);
   }
   
+  if (opb)
+  {
+    /* must be equal with cover size */
+    cnf.add_pb_equal (PBVector (sets_n, 1),
+          get_literals_from_range (set_vars, set_vars + sets_n), cover_size);
+    return;
+  }
+  
   LiteralVector out = cnf.add_vars_with_literals (cover_size_bits_n);
   LiteralMatrix dadda_matrix (cover_size_bits_n);
   /* prepare dadda adder matrix */
@@ -24,6 +24,7 @@ public:
   
 private:
   guint cover_size;
+  bool opb; /* generate pseudo-Boolean constraint instead of adders */
   
   guint sets_n;
   guint elems_n;
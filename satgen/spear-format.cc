@@ -209,7 +209,11 @@ SpearFormatModule::get_integer_type (std::string::const_iterator& start,
       throw InputSyntaxError (lineno, "Cant parse number of bits");
     if (bits > 64 || bits == 0)
       throw InputSyntaxError (lineno, "Bits number must be in range 1-64");
-    start += is.tellg (); /* next position */
+    /* tellg fails if number ends a line */
+    if (is.eof ())
+      start = end;
+    else
+      start += is.tellg (); /* next position */
   }
   /* must be space after bits number if not end of line */
   if (start != end && !isspace (*start))
@@ -12,9 +12,10 @@
 using namespace SatUtils;
 
 SubsetSumModule::SubsetSumModule ()
-    : result_value (0)
+    : result_value (0), opb (false)
 {
   add_param ("sum", "Required result of subset sum", result_value);
+  add_param ("opb", "Generate pseudo-Boolean constraint (OPB)", opb);
 }
 
 SubsetSumModule::~SubsetSumModule ()
@@ -160,6 +161,29 @@ void
 SubsetSumModule::generate (CNF& cnf, std::string& outmap_string,
     bool with_outmap) const
 {
+  if (opb)
+  {
+    /* one switch per number: sum of chosen numbers is result */
+    gint32 switches = cnf.next_var ();
+    cnf.add_vars (numbers.size ());
+    LiteralVector vars = get_literals_from_range (switches,
+          switches + numbers.size ());
+    if (with_outmap)
+    {
+      outmap_string.clear ();
+      for (guint i = 0; i < numbers.size (); i++)
+      {
+        std::ostringstream os;
+        os << "{ {|" << numbers[i] << "\n} :" << switches + i << " }";
+        outmap_string += os.str ();
+      }
+    }
+    if (result_value == 0) /* add clause for nonempty subset */
+      cnf.add_clause (vars);
+    cnf.add_pb_equal (numbers, vars, result_value);
+    return;
+  }
+
   gint64 neg_sum = 0;
   gint64 pos_sum = 0;
   /* negnums - absolute values of negative numbers from set,
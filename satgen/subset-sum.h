@@ -15,6 +15,7 @@ class SubsetSumModule: public SatGenModule
 {
 private:
   gint64 result_value; /* result of subset sum */
+  bool opb; /* generate pseudo-Boolean constraint instead of adders */
   
   std::vector<gint64> numbers;
   
@@ -24,7 +24,31 @@ check_cnf_satisfability (const CNF& cnf, const LiteralVector& vars,
   for (guint i = 0; i < vars.size (); i++)
     inputs[vars[i]-1] = ((val & (1ULL << i)) == (1ULL << i));
   
-  if (others.size ())
+  if (others.size () >= 6)
+  { /* check 64 combinations at once: 6 others vars gives all 64 combinations
+     * in single word, rest of others vars are enumerated */
+    static const guint64 comb_words[6] =
+    {
+      0xaaaaaaaaaaaaaaaaULL, 0xccccccccccccccccULL, 0xf0f0f0f0f0f0f0f0ULL,
+      0xff00ff00ff00ff00ULL, 0xffff0000ffff0000ULL, 0xffffffff00000000ULL
+    };
+    PackedAssignments packed (cnf.get_vars_n (), 64);
+    std::vector<guint64> result;
+    for (guint i = 0; i < vars.size (); i++)
+      packed.fill (vars[i]-1, inputs[vars[i]-1]);
+    for (guint j = 0; j < 6; j++)
+      packed.var_words (others[j]-1)[0] = comb_words[j];
+    
+    guint64 comb_num = 1ULL << (others.size ()-6);
+    for (guint64 v = 0; v < comb_num; v++)
+    {
+      for (guint j = 6; j < others.size (); j++)
+	packed.fill (others[j]-1, (v & (1ULL << (j-6))) != 0);
+      if (cnf.evaluate (packed, result))
+	return true;
+    }
+  }
+  else if (others.size ())
   {
     guint64 comb_num = 1ULL << others.size ();
     for (guint64 v = 0; v < comb_num; v++)
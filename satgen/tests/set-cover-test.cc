@@ -134,7 +134,54 @@ set_parse_test ()
   return true;
 }
 
-
+bool
+set_cover_opb_test ()
+{
+  static const char* text_input =
+  "set1 = { aa bb c d }\n"
+  "set2 = { bb d e g }\n"
+  "set3 = { e hi k }\n"
+  "set4 = { aa d k }\n"
+  "set5 = { bb hi g k }\n";
+  
+  static const bool covers[3][5] =
+  {
+    { true, false, true, false, true },
+    { true, true, true, false, true }, /* too big */
+    { true, false, true, false, false } /* g is not covered */
+  };
+  static const bool results[3] = { true, false, false };
+  
+  try
+  {
+    SetCoverModule* module = static_cast<SetCoverModule*>
+        (SetCoverModule::create ());
+    module->parse_params ("cover_size=3:opb");
+    module->parse_input (text_input);
+    
+    std::cout << "Generating OPB set cover" << std::endl;
+    CNF cnf;
+    std::string outmap;
+    module->generate (cnf, outmap, false);
+    delete module;
+    if (cnf.get_vars_n () != 5 || cnf.get_clauses_n () != 8 ||
+        cnf.get_pbs_n () != 2)
+      return false;
+    for (guint i = 0; i < 3; i++)
+    {
+      std::vector<bool> model (covers[i], covers[i] + 5);
+      if (cnf.evaluate (model) != results[i])
+        return false;
+    }
+  }
+  catch (Glib::Exception& ex)
+  {
+    std::cerr << ex.what () << std::endl;
+    return false;
+  }
+  
+  return true;
+}
 
 int
 main (int argc, char** argv)
@@ -144,5 +191,10 @@ main (int argc, char** argv)
     std::cerr << "Set parsing test is FAILED!" << std::endl;
     return 1;
   }
+  if (!set_cover_opb_test ())
+  {
+    std::cerr << "Set cover OPB test is FAILED!" << std::endl;
+    return 1;
+  }
   return 0;
 }
@@ -14,9 +14,10 @@
 using namespace SatUtils;
 
 VertexCoverModule::VertexCoverModule ()
-    : cover_size (3)
+    : cover_size (3), opb (false)
 {
   add_param ("cover_size", "Cover size", cover_size);
+  add_param ("opb", "Generate pseudo-Boolean constraint (OPB)", opb);
 }
 
 VertexCoverModule::~VertexCoverModule ()
@@ -68,6 +69,14 @@ VertexCoverModule::generate (CNF& cnf, std::string& outmap_string,
   for (EdgeConstIter edge = edges.begin (); edge != edges.end (); ++edge)
     cnf.add_clause (vertex_vars + edge->first, vertex_vars + edge->second);
   
+  if (opb)
+  {
+    /* must be equal with cover size */
+    cnf.add_pb_equal (PBVector (vertices_n, 1),
+          get_literals_from_range (vertex_vars, vertex_vars + vertices_n), cover_size);
+    return;
+  }
+  
   LiteralVector out = cnf.add_vars_with_literals (cover_size_bits_n);
   LiteralMatrix dadda_matrix (cover_size_bits_n);
   /* prepare dadda adder matrix */
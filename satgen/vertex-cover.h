@@ -18,6 +18,7 @@ public:
   
 private:
   guint cover_size;
+  bool opb; /* generate pseudo-Boolean constraint instead of adders */
   
   guint vertices_n;
   std::vector<std::string> vertex_names;
@@ -12,6 +12,8 @@
 #include <glibmm.h>
 #include <satutils.h>
 
+using namespace SatUtils;
+
 static bool
 parse_dimacs_output (std::istream& file, std::vector<bool>& instance, bool& sat)
 {
@@ -63,171 +65,6 @@ parse_dimacs_output (std::istream& file, std::vector<bool>& instance, bool& sat)
   return true;
 }
 
-bool
-print_output_based_on_outmap (std::istream& file,
-      const std::vector<bool>& instance, bool sat)
-{
-  if (!sat)
-  {
-    std::cout << "Formulae is unsatisfiable!" << std::endl;
-    return true;
-  }
-  if (instance.size () == 0)
-  {
-    std::cout << "Formulae is satisfiable." << std::endl;
-    return true;
-  }
-  
-  while (1)
-  {
-    char c;
-    c = file.get ();
-    if (file.eof ())
-      break;
-    if (c == '\\')
-    {
-      c = file.get ();
-      if (file.eof ())
-        break;
-      std::cout << c;
-      continue;
-    }
-    else if (c == '{')
-    { /* conversion */
-      std::vector<std::string> choices;
-      char conversion;
-      file >> conversion;
-      if (conversion != 'u' && conversion != 's' &&
-          conversion != 'x' && conversion != 'o' && conversion != '{')
-      {
-        std::cerr << "Bad conversion type" << std::endl;
-        return false;
-      }
-      
-      if (conversion == '{')
-      {
-        bool closed = false;
-        guint choice = 0;
-        choices.resize (1);
-        while (1)
-        {
-          char c;
-          c = file.get ();
-          if (file.eof ())
-            break;
-          if (c == '\\')
-          {
-            c = file.get ();
-            if (file.eof ())
-              break;
-            choices[choice].push_back (c);
-            continue;
-          }
-          else if (c == '}')
-          {
-            closed = true;
-            break;
-          }
-          else if (c == '|')
-          {
-            choice++;
-            choices.resize (choices.size () + 1);
-          }
-          else
-            choices[choice].push_back (c);
-        }
-        if (!closed)
-        {
-          std::cerr << "Braces is not closed" << std::endl;
-          return false;
-        }
-      }
-      
-      file >> c;
-      if (c != ':')
-      {
-        std::cerr << "Colon is required after conversion type" << std::endl;
-        return false;
-      }
-      
-      guint64 value = 0;
-      guint bit;
-      for (bit = 0; bit < 65; bit++)
-      {
-        file >> c;
-        if (file.eof ())
-        {
-          std::cerr << "Not closed brace at end file" << std::endl;
-          return false;
-        }
-        if (c == '}') /* if end of conversion */
-          break;
-        file.unget ();
-        
-        gint32 literal;
-        file >> literal;
-        if (file.fail ())
-        {
-          std::cerr << "Bad literal in conversion" << std::endl;
-          return false;
-        }
-        if (literal == 0)
-        {
-          std::cerr << "Bad literal must be nonzero" << std::endl;
-          return false;
-        }
-        gint32 valnum = std::abs (literal);
-        if (guint32 (valnum) <= instance.size ())
-          value |= (instance[valnum-1] == (literal > 0)) ? (1ULL << bit) : 0;
-      }
-      
-      if (bit == 65)
-      {
-        std::cerr <<
-          "Only 64 literals is possible to use in conversion" << std::endl;
-        return false;
-      }
-      
-      if (bit != 0)
-      {
-	if (conversion == 's')
-	{ /* expand sign */
-	  if (value & (1ULL << (bit-1)))
-	    value |= (G_MAXUINT64 ^ ((1ULL << bit)-1));
-	}
-	
-	switch (conversion)
-	{
-	  case 'u':
-	    std::cout << std::dec << guint64 (value);
-	    break;
-	  case 's':
-	    std::cout << std::dec << gint64 (value);
-	    break;
-	  case 'x':
-	    std::cout << std::hex << guint64 (value);
-	    break;
-	  case 'o':
-	    std::cout << std::oct << guint64 (value);
-	    break;
-	  case '{':
-	    if (value < choices.size ())
-	      std::cout << choices[value];
-	    else
-	      std::cout << "{!!!OUT OF RANGE!!!:" << value << '}';
-	    break;
-	  default:
-	    break;
-	}
-      }
-    }
-    else
-      std::cout << c;
-  }
-  std::cout.flush ();
-  return true;
-}
-
 /* main function */
 
 int
@@ -277,7 +114,8 @@ main (int argc, char** argv)
 	return 1;
       }
       file.exceptions (std::ios_base::badbit);
-      if (!print_output_based_on_outmap (file, instance, satisfiable))
+      if (!print_output_based_on_outmap (file, instance, satisfiable,
+	      std::cout))
         return 1;
     }
   }